@@ -0,0 +1,107 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "AllocationProfiler.h"
+#include "Interpreter.h"
+#include "LoxFunction.h"
+#include "Stats.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+namespace
+{
+    // innermost first: the allocating function and line, then its callers.
+    using CallStack = std::vector<std::pair<FunctionStmt*, std::size_t>>;
+
+    struct Site
+    {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+    };
+
+    const Interpreter* attached = nullptr;
+    std::map<std::pair<CallStack, const std::type_info*>, Site> sites;
+    std::size_t totalCount = 0;
+    std::size_t totalBytes = 0;
+
+    std::string typeName(const std::type_info & type)
+    {
+        return type == typeid(std::string) ? "string" : Stats::typeName(type);
+    }
+
+    std::string describe(const CallStack & stack)
+    {
+        std::string description;
+        for (auto & [function, line] : stack)
+        {
+            if (!description.empty()) description += " <- ";
+            description += (function == nullptr ? "<script>" : function->name.lexeme) + ":" + std::to_string(line);
+        }
+        return description;
+    }
+
+    void printSites(std::ostream & out, const char* title, std::vector<const decltype(sites)::value_type*> entries)
+    {
+        out << '\n' << title << '\n'
+            << std::setw(12) << "count" << std::setw(14) << "bytes" << "  " << std::left << std::setw(14) << "type" << std::right << "site\n";
+        for (auto entry : entries)
+        {
+            out << std::setw(12) << entry->second.count << std::setw(14) << entry->second.bytes << "  "
+                << std::left << std::setw(14) << typeName(*entry->first.second) << std::right
+                << describe(entry->first.first) << '\n';
+        }
+    }
+}
+
+void AllocationProfiler::attach(const Interpreter* interpreter)
+{
+    attached = interpreter;
+}
+
+void AllocationProfiler::allocated(const std::type_info & type, std::size_t bytes)
+{
+    if (attached == nullptr) return;
+
+    auto & frames = attached->callStack();
+    CallStack stack;
+    stack.reserve(frames.size() + 1);
+
+    // each frame is executing the line its callee was called from.
+    // recursion is folded: a location already in the stack is not repeated.
+    auto line = attached->line();
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame)
+    {
+        std::pair<FunctionStmt*, std::size_t> location { frame->function->getDeclaration(), line };
+        if (std::find(stack.begin(), stack.end(), location) == stack.end()) stack.push_back(location);
+        line = frame->line;
+    }
+    stack.emplace_back(nullptr, line);
+
+    auto & site = sites[{ std::move(stack), &type }];
+    site.count++;
+    site.bytes += bytes;
+
+    totalCount++;
+    totalBytes += bytes;
+}
+
+void AllocationProfiler::report(std::ostream & out, std::size_t top)
+{
+    out << "allocations: " << totalCount << " objects, " << totalBytes << " bytes\n";
+
+    std::vector<const decltype(sites)::value_type*> entries;
+    for (auto & entry : sites)
+    {
+        entries.push_back(&entry);
+    }
+
+    auto limit = std::min(top, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + limit, entries.end(), [](auto a, auto b) { return a->second.count > b->second.count; });
+    printSites(out, "top sites by count", { entries.begin(), entries.begin() + limit });
+
+    std::partial_sort(entries.begin(), entries.begin() + limit, entries.end(), [](auto a, auto b) { return a->second.bytes > b->second.bytes; });
+    printSites(out, "top sites by bytes", { entries.begin(), entries.begin() + limit });
+}
@@ -0,0 +1,36 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_ALLOCATIONPROFILER_H
+#define LOXPLUS_ALLOCATIONPROFILER_H
+
+#include <ostream>
+#include <typeinfo>
+
+class Interpreter;
+
+/*
+ * Allocation profiler for --alloc-profile. While an interpreter is
+ * attached, every object created through CreatableType and every string
+ * built by concatenation is attributed to the Lox call stack and line that
+ * allocated it, recursion folded. Bytes are the size of the objects
+ * themselves, plus the characters for strings.
+ * */
+class AllocationProfiler
+{
+public:
+    AllocationProfiler() = delete;
+
+    static inline bool enabled = false;
+
+    // the interpreter whose call stack allocations are attributed to, nullptr to stop recording.
+    static void attach(const Interpreter* interpreter);
+    static void allocated(const std::type_info & type, std::size_t bytes);
+
+    // the 'top' allocation sites by count and by bytes.
+    static void report(std::ostream & out, std::size_t top);
+};
+
+
+#endif //LOXPLUS_ALLOCATIONPROFILER_H
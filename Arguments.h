@@ -0,0 +1,38 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_ARGUMENTS_H
+#define LOXPLUS_ARGUMENTS_H
+
+#include <cstddef>
+#include "Object.h"
+
+/*
+ * View over the arguments of a call. They live on the interpreter's value
+ * stack and stay valid until the callee evaluates Lox code, so callees
+ * copy what they need first.
+ * */
+class Arguments
+{
+public:
+    // the parser refuses calls with more arguments.
+    static constexpr std::size_t capacity = 8;
+
+    Arguments(const Object* data, std::size_t count)
+        : data { data }, count { count }
+    {
+    }
+
+    std::size_t size() const { return count; }
+    const Object & operator[](std::size_t index) const { return data[index]; }
+
+    const Object* begin() const { return data; }
+    const Object* end() const { return data + count; }
+
+private:
+    const Object* data;
+    std::size_t count;
+};
+
+#endif //LOXPLUS_ARGUMENTS_H
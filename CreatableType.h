@@ -7,6 +7,10 @@
 
 #include <vector>
 #include <memory>
+#include <type_traits>
+#include "AllocationProfiler.h"
+#include "Heap.h"
+#include "Stats.h"
 
 template <typename T>
 class CreatableType
@@ -15,8 +19,17 @@ public:
     template <typename... Args>
     static T* create(Args&&... args)
     {
-        objects.emplace_back(new T { std::forward<Args>(args)... });
-        return objects.back().get();
+        if (Stats::enabled) Stats::allocated(Stats::counter<T>());
+        if (AllocationProfiler::enabled) AllocationProfiler::allocated(typeid(T), sizeof(T));
+        if constexpr (std::is_base_of_v<HeapObject, T>)
+        {
+            return Heap::allocate<T>(std::forward<Args>(args)...);
+        }
+        else
+        {
+            objects.emplace_back(new T { std::forward<Args>(args)... });
+            return objects.back().get();
+        }
     }
 
 private:
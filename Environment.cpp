@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include "Environment.h"
+#include "Heap.h"
 #include "RuntimeError.h"
 
 Environment::Environment(Environment* enclosing)
@@ -13,20 +14,22 @@ Environment::Environment(Environment* enclosing)
 
 void Environment::define(std::string name, Object value)
 {
-    values.emplace(name, value);
+    Heap::Mutation mutation { this };
+    mutation.store(values[std::move(name)], std::move(value));
 }
 
 void Environment::assign(Token name, Object value)
 {
     if (values.count(name.lexeme))
     {
-        values[name.lexeme] = value;
+        Heap::Mutation mutation { this };
+        mutation.store(values[name.lexeme], std::move(value));
         return;
     }
 
     if (enclosing != nullptr)
     {
-        enclosing->assign(name, value);
+        enclosing->assign(name, std::move(value));
         return;
     }
 
@@ -45,9 +48,20 @@ Object Environment::get(Token name)
     throw RuntimeError(name, "Undefined variable '" + name.lexeme + "'.");
 }
 
+Object* Environment::slot(const std::string & name)
+{
+    // stores through the slot bypass the write barrier.
+    Heap::remember(this);
+    // it may insert the variable.
+    Heap::Mutation mutation { this };
+    return &values[name];
+}
+
 Object Environment::getAt(unsigned long distance, const std::string name)
 {
-    return ancestor(distance)->values[name];
+    auto & values = ancestor(distance)->values;
+    auto it = values.find(name);
+    return it != values.end() ? it->second : Object {};
 }
 
 Environment* Environment::ancestor(unsigned long distance)
@@ -67,6 +81,45 @@ Environment* Environment::ancestor(unsigned long distance)
 
 void Environment::assignAt(unsigned long distance, Token name, Object value)
 {
-    ancestor(distance)->values[name.lexeme] = std::move(value);
+    auto environment = ancestor(distance);
+    Heap::Mutation mutation { environment };
+    mutation.store(environment->values[name.lexeme], std::move(value));
+}
+
+
+void Environment::trace(Tracer & tracer)
+{
+    for (auto & [name, value] : values)
+    {
+        tracer.trace(value);
+    }
+    tracer.trace(enclosing);
+}
+
+std::size_t Environment::heapSize() const
+{
+    return sizeof(*this) + mapSize(values);
+}
+
+std::string Environment::describe() const
+{
+    constexpr std::size_t shown = 6;
+
+    std::string names;
+    std::size_t count = 0;
+    for (auto & [name, value] : values)
+    {
+        if (count++ == shown)
+        {
+            names += ", ...";
+            break;
+        }
+        names += (names.empty() ? "" : ", ") + name;
+    }
+    return "Environment {" + names + "}";
 }
 
+HeapObject* Environment::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
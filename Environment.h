@@ -11,8 +11,9 @@
 #include "Object.h"
 #include "Token.h"
 #include "CreatableType.h"
+#include "HeapObject.h"
 
-class Environment : public CreatableType<Environment>
+class Environment : public HeapObject, public CreatableType<Environment>
 {
 public:
     Environment() = default;
@@ -22,10 +23,18 @@ public:
     void assign(Token name, Object value);
     Object get(Token name);
 
+    // address of a variable defined in this environment, stable until the environment dies.
+    Object* slot(const std::string & name);
+
     Object getAt(unsigned long distance, std::string name);
 
     void assignAt(unsigned long distance, Token name, Object value);
 
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
 private:
     std::map<std::string, Object> values;
     Environment* enclosing = nullptr;
@@ -0,0 +1,357 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "EscapeAnalysis.h"
+
+EscapeAnalysis::EscapeAnalysis(Interpreter & interpreter)
+    : interpreter { interpreter }
+{
+
+}
+
+void EscapeAnalysis::visitArrayExpr(ArrayExpr & expr)
+{
+    for (auto & element : expr.elements)
+    {
+        analyse(element);
+    }
+}
+
+void EscapeAnalysis::visitAssignExpr(AssignExpr & expr)
+{
+    // overwriting a candidate variable does not leak the instance it held.
+    analyse(expr.value);
+}
+
+void EscapeAnalysis::visitBinaryExpr(BinaryExpr & expr)
+{
+    if (expr.op.type == TokenType::EQUAL_EQUAL || expr.op.type == TokenType::BANG_EQUAL)
+    {
+        analyseOperand(expr.left);
+        analyseOperand(expr.right);
+    }
+    else
+    {
+        analyse(expr.left);
+        analyse(expr.right);
+    }
+}
+
+void EscapeAnalysis::visitCallExpr(CallExpr & expr)
+{
+    // calling a method binds 'this' for the duration of the call only,
+    // except for 'init' which returns it.
+    auto* method = dynamic_cast<GetExpr*>(expr.callee);
+    if (auto candidate = method != nullptr ? tracked(method->object) : nullptr; candidate != nullptr)
+    {
+        if (method->name.lexeme == "init") candidate->escapes = true;
+    }
+    else
+    {
+        analyse(expr.callee);
+    }
+
+    for (auto & argument : expr.arguments)
+    {
+        analyse(argument);
+    }
+}
+
+void EscapeAnalysis::visitGetExpr(GetExpr & expr)
+{
+    if (auto candidate = tracked(expr.object); candidate != nullptr)
+    {
+        // reading a method creates a bound function holding the instance.
+        if (expr.name.lexeme == "init" || isMethod(candidate->klass, expr.name.lexeme))
+        {
+            candidate->escapes = true;
+        }
+    }
+    else
+    {
+        analyse(expr.object);
+    }
+}
+
+void EscapeAnalysis::visitGroupingExpr(GroupingExpr & expr)
+{
+    analyse(expr.expression);
+}
+
+void EscapeAnalysis::visitIndexExpr(IndexExpr & expr)
+{
+    analyse(expr.object);
+    analyse(expr.index);
+}
+
+void EscapeAnalysis::visitIndexSetExpr(IndexSetExpr & expr)
+{
+    // storing an instance in an array leaks it.
+    analyse(expr.object);
+    analyse(expr.index);
+    analyse(expr.value);
+}
+
+void EscapeAnalysis::visitLiteralExpr(LiteralExpr & expr)
+{
+}
+
+void EscapeAnalysis::visitLogicalExpr(LogicalExpr & expr)
+{
+    analyse(expr.left);
+    analyse(expr.right);
+}
+
+void EscapeAnalysis::visitSetExpr(SetExpr & expr)
+{
+    if (tracked(expr.object) == nullptr)
+    {
+        analyse(expr.object);
+    }
+    analyse(expr.value);
+}
+
+void EscapeAnalysis::visitThisExpr(ThisExpr & expr)
+{
+    if (thisCandidate != nullptr)
+    {
+        thisCandidate->escapes = true;
+    }
+}
+
+void EscapeAnalysis::visitUnaryExpr(UnaryExpr & expr)
+{
+    analyse(expr.right);
+}
+
+void EscapeAnalysis::visitVariableExpr(VariableExpr & expr)
+{
+    bool captured;
+    if (auto candidate = lookUp(expr.name.lexeme, captured); candidate != nullptr)
+    {
+        candidate->escapes = true;
+    }
+}
+
+void EscapeAnalysis::visitWhileStmt(WhileStmt & stmt)
+{
+    analyse(stmt.condition);
+    analyse(stmt.body);
+}
+
+void EscapeAnalysis::visitBlockStmt(BlockStmt & stmt)
+{
+    beginScope();
+    analyseBlock(stmt.statements);
+    endScope();
+}
+
+void EscapeAnalysis::visitClassStmt(ClassStmt & stmt)
+{
+    declare(stmt.name, nullptr);
+
+    auto enclosingCandidate = thisCandidate;
+    auto enclosingFunction = thisFunction;
+
+    Candidate self { nullptr, &stmt };
+    thisCandidate = collectingClasses ? &self : nullptr;
+    thisFunction = functions.size() + 1;
+
+    for (auto & method : stmt.methods)
+    {
+        analyseFunction(*method);
+    }
+
+    if (collectingClasses && !self.escapes)
+    {
+        classes[stmt.name.lexeme] = &stmt;
+    }
+
+    thisCandidate = enclosingCandidate;
+    thisFunction = enclosingFunction;
+}
+
+void EscapeAnalysis::visitExpressionStmt(ExpressionStmt & stmt)
+{
+    analyse(stmt.expression);
+}
+
+void EscapeAnalysis::visitForStmt(ForStmt & stmt)
+{
+    beginScope();
+    if (stmt.initializer != nullptr) analyse(stmt.initializer);
+    if (stmt.condition != nullptr) analyse(stmt.condition);
+    if (stmt.increment != nullptr) analyse(stmt.increment);
+    analyse(stmt.body);
+    endScope();
+}
+
+void EscapeAnalysis::visitFunctionStmt(FunctionStmt & stmt)
+{
+    declare(stmt.name, nullptr);
+    analyseFunction(stmt);
+}
+
+void EscapeAnalysis::visitIfStmt(IfStmt & stmt)
+{
+    analyse(stmt.condition);
+    analyse(stmt.thenBranch);
+    if (stmt.elseBranch != nullptr) analyse(stmt.elseBranch);
+}
+
+void EscapeAnalysis::visitPrintStmt(PrintStmt & stmt)
+{
+    analyseOperand(stmt.expression);
+}
+
+void EscapeAnalysis::visitReturnStmt(ReturnStmt & stmt)
+{
+    if (stmt.value != nullptr) analyse(stmt.value);
+}
+
+void EscapeAnalysis::visitVarStmt(VarStmt & stmt)
+{
+    Candidate* candidate = nullptr;
+
+    if (stmt.initializer != nullptr)
+    {
+        analyse(stmt.initializer);
+
+        auto* call = dynamic_cast<CallExpr*>(stmt.initializer);
+        auto* callee = call != nullptr ? dynamic_cast<VariableExpr*>(call->callee) : nullptr;
+        if (!collectingClasses && !functions.empty() && callee != nullptr && classes.count(callee->name.lexeme))
+        {
+            candidates.push_back(std::make_unique<Candidate>(Candidate { call, classes[callee->name.lexeme] }));
+            candidate = candidates.back().get();
+        }
+    }
+
+    declare(stmt.name, candidate);
+}
+
+void EscapeAnalysis::visitYieldStmt(YieldStmt & stmt)
+{
+    // a method yielding is a generator, which holds 'this' after the call returns.
+    if (thisCandidate != nullptr && functions.size() == thisFunction) thisCandidate->escapes = true;
+
+    if (stmt.value != nullptr) analyse(stmt.value);
+}
+
+void EscapeAnalysis::analyse(const std::vector<Stmt*> & statements)
+{
+    collectingClasses = true;
+    analyseBlock(statements);
+
+    collectingClasses = false;
+    analyseBlock(statements);
+
+    for (auto & candidate : candidates)
+    {
+        if (!candidate->escapes)
+        {
+            interpreter.resolveStackAllocation(*candidate->allocation, candidate->klass);
+        }
+    }
+}
+
+void EscapeAnalysis::analyseBlock(const std::vector<Stmt*> & statements)
+{
+    for (auto & statement : statements)
+    {
+        analyse(statement);
+    }
+}
+
+void EscapeAnalysis::analyse(Stmt* stmt)
+{
+    stmt->accept(*this);
+}
+
+void EscapeAnalysis::analyse(Expr* expr)
+{
+    expr->accept(*this);
+}
+
+void EscapeAnalysis::beginScope()
+{
+    scopes.emplace_back();
+}
+
+void EscapeAnalysis::endScope()
+{
+    scopes.pop_back();
+}
+
+void EscapeAnalysis::declare(const Token & name, Candidate* candidate)
+{
+    if (scopes.empty()) return;
+    scopes.back()[name.lexeme] = candidate;
+}
+
+void EscapeAnalysis::analyseFunction(FunctionStmt & function)
+{
+    functions.push_back(scopes.size());
+    beginScope();
+    for (auto & param : function.parameters)
+    {
+        declare(param, nullptr);
+    }
+    analyseBlock(function.body);
+    endScope();
+    functions.pop_back();
+}
+
+EscapeAnalysis::Candidate* EscapeAnalysis::tracked(Expr* expr)
+{
+    if (auto* variable = dynamic_cast<VariableExpr*>(expr); variable != nullptr)
+    {
+        bool captured;
+        auto candidate = lookUp(variable->name.lexeme, captured);
+        return captured ? nullptr : candidate;
+    }
+
+    if (dynamic_cast<ThisExpr*>(expr) != nullptr && functions.size() == thisFunction)
+    {
+        return thisCandidate;
+    }
+
+    return nullptr;
+}
+
+EscapeAnalysis::Candidate* EscapeAnalysis::lookUp(const std::string & name, bool & captured)
+{
+    captured = false;
+
+    auto size = static_cast<long int>(scopes.size());
+    for (auto i = size - 1; i >= 0; i--)
+    {
+        if (auto it = scopes[i].find(name); it != scopes[i].end())
+        {
+            // referenced from a nested function, the closure keeps it alive.
+            captured = !functions.empty() && static_cast<std::size_t>(i) < functions.back();
+            if (captured && it->second != nullptr) it->second->escapes = true;
+            return it->second;
+        }
+    }
+
+    return nullptr;
+}
+
+bool EscapeAnalysis::isMethod(ClassStmt* klass, const std::string & name)
+{
+    for (auto & method : klass->methods)
+    {
+        if (method->name.lexeme == name) return true;
+    }
+
+    return false;
+}
+
+void EscapeAnalysis::analyseOperand(Expr* expr)
+{
+    if (tracked(expr) == nullptr)
+    {
+        analyse(expr);
+    }
+}
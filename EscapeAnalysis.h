@@ -0,0 +1,97 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_ESCAPEANALYSIS_H
+#define LOXPLUS_ESCAPEANALYSIS_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ast.h"
+#include "Interpreter.h"
+
+/*
+ * Finds the "var x = Klass(...);" declarations, inside functions, whose
+ * instance can never outlive the call: 'x' is only used to read or write
+ * fields, call methods, be printed or compared, and the class' methods
+ * never let 'this' escape either. The interpreter allocates those
+ * instances in a slot owned by the call frame instead of the heap.
+ * */
+class EscapeAnalysis : public VisitorExpr, public VisitorStmt
+{
+public:
+    explicit EscapeAnalysis(Interpreter & interpreter);
+
+    void visitArrayExpr(ArrayExpr & expr) override;
+    void visitAssignExpr(AssignExpr & expr) override;
+    void visitBinaryExpr(BinaryExpr & expr) override;
+    void visitCallExpr(CallExpr & expr) override;
+    void visitGetExpr(GetExpr & expr) override;
+    void visitGroupingExpr(GroupingExpr & expr) override;
+    void visitIndexExpr(IndexExpr & expr) override;
+    void visitIndexSetExpr(IndexSetExpr & expr) override;
+    void visitLiteralExpr(LiteralExpr & expr) override;
+    void visitLogicalExpr(LogicalExpr & expr) override;
+    void visitSetExpr(SetExpr & expr) override;
+    void visitThisExpr(ThisExpr & expr) override;
+    void visitUnaryExpr(UnaryExpr & expr) override;
+    void visitVariableExpr(VariableExpr & expr) override;
+    void visitWhileStmt(WhileStmt & stmt) override;
+
+    void visitBlockStmt(BlockStmt & stmt) override;
+    void visitClassStmt(ClassStmt & stmt) override;
+    void visitExpressionStmt(ExpressionStmt & stmt) override;
+    void visitForStmt(ForStmt & stmt) override;
+    void visitFunctionStmt(FunctionStmt & stmt) override;
+    void visitIfStmt(IfStmt & stmt) override;
+    void visitPrintStmt(PrintStmt & stmt) override;
+    void visitReturnStmt(ReturnStmt & stmt) override;
+    void visitVarStmt(VarStmt & stmt) override;
+    void visitYieldStmt(YieldStmt & stmt) override;
+
+    void analyse(const std::vector<Stmt*> & statements);
+
+private:
+    struct Candidate
+    {
+        CallExpr* allocation;
+        ClassStmt* klass;
+        bool escapes = false;
+    };
+
+    Interpreter & interpreter;
+
+    // first pass collects the classes that keep 'this' to themselves, the second one the allocations.
+    bool collectingClasses = true;
+    std::map<std::string, ClassStmt*> classes;
+
+    // nullptr entries are declarations shadowing a candidate.
+    std::vector<std::map<std::string, Candidate*>> scopes;
+    // index of the first scope of each function being analysed.
+    std::vector<std::size_t> functions;
+    std::vector<std::unique_ptr<Candidate>> candidates;
+
+    // 'this' of the class being checked, only tracked directly inside its methods.
+    Candidate* thisCandidate = nullptr;
+    std::size_t thisFunction = 0;
+
+    void analyseBlock(const std::vector<Stmt*> & statements);
+    void analyse(Stmt* stmt);
+    void analyse(Expr* expr);
+
+    void beginScope();
+    void endScope();
+    void declare(const Token & name, Candidate* candidate);
+    void analyseFunction(FunctionStmt & function);
+
+    Candidate* tracked(Expr* expr);
+    Candidate* lookUp(const std::string & name, bool & captured);
+    bool isMethod(ClassStmt* klass, const std::string & name);
+    // analyses 'expr' unless it is a tracked value used in a way that does not leak it.
+    void analyseOperand(Expr* expr);
+};
+
+
+#endif //LOXPLUS_ESCAPEANALYSIS_H
@@ -0,0 +1,105 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "ExecutionCounts.h"
+#include "Stats.h"
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+namespace
+{
+    std::size_t total = 0;
+    std::map<const std::type_info*, std::size_t> kinds;
+    std::vector<const std::type_info*> kindNames;
+    std::vector<std::size_t> kindCounts;
+    std::map<std::pair<std::size_t, std::size_t>, std::size_t> pairs;
+    std::vector<std::size_t> lines;
+    std::map<FunctionStmt*, std::size_t> functions;
+
+    std::size_t previousKind = SIZE_MAX;
+
+    template <typename Key>
+    std::vector<std::pair<Key, std::size_t>> mostFrequent(const std::map<Key, std::size_t> & counts, std::size_t top)
+    {
+        std::vector<std::pair<Key, std::size_t>> sorted { counts.begin(), counts.end() };
+        std::sort(sorted.begin(), sorted.end(), [](const auto & a, const auto & b) { return a.second > b.second; });
+        if (sorted.size() > top) sorted.resize(top);
+        return sorted;
+    }
+}
+
+void ExecutionCounts::count(const std::type_info & kind, std::size_t line, FunctionStmt* function)
+{
+    auto [it, inserted] = kinds.try_emplace(&kind, kindNames.size());
+    if (inserted)
+    {
+        kindNames.push_back(&kind);
+        kindCounts.push_back(0);
+    }
+    auto id = it->second;
+
+    total++;
+    kindCounts[id]++;
+    if (previousKind != SIZE_MAX) pairs[{ previousKind, id }]++;
+    previousKind = id;
+
+    if (line >= lines.size()) lines.resize(line + 1);
+    lines[line]++;
+
+    functions[function]++;
+}
+
+void ExecutionCounts::report(std::ostream & out, std::string_view source, std::size_t top)
+{
+    std::vector<std::string> names;
+    for (auto kind : kindNames)
+    {
+        names.push_back(Stats::typeName(*kind));
+    }
+
+    out << "counts: " << total << " nodes executed\n\n";
+
+    out << std::setw(12) << "count" << "  function\n";
+    for (auto & [function, count] : mostFrequent(functions, top))
+    {
+        out << std::setw(12) << count << "  " << (function == nullptr ? "<script>" : function->name.lexeme) << '\n';
+    }
+
+    std::map<std::size_t, std::size_t> byKind;
+    for (std::size_t id = 0; id < kindCounts.size(); id++)
+    {
+        byKind[id] = kindCounts[id];
+    }
+    out << '\n' << std::setw(12) << "count" << "  kind\n";
+    for (auto & [id, count] : mostFrequent(byKind, top))
+    {
+        out << std::setw(12) << count << "  " << names[id] << '\n';
+    }
+
+    out << '\n' << std::setw(12) << "count" << "  pair\n";
+    for (auto & [pair, count] : mostFrequent(pairs, top))
+    {
+        out << std::setw(12) << count << "  " << names[pair.first] << " -> " << names[pair.second] << '\n';
+    }
+
+    out << '\n';
+    std::size_t line = 1;
+    for (std::size_t start = 0; start < source.size(); line++)
+    {
+        auto end = std::min(source.find('\n', start), source.size());
+        if (line < lines.size() && lines[line] > 0)
+        {
+            out << std::setw(12) << lines[line];
+        }
+        else
+        {
+            out << std::setw(12) << "";
+        }
+        out << " | " << source.substr(start, end - start) << '\n';
+        start = end + 1;
+    }
+}
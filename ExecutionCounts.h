@@ -0,0 +1,34 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_EXECUTIONCOUNTS_H
+#define LOXPLUS_EXECUTIONCOUNTS_H
+
+#include <ostream>
+#include <string_view>
+#include <typeinfo>
+#include "ast.h"
+
+/*
+ * Exact execution counts for --counts: every statement executed and every
+ * expression evaluated is counted by kind, by source line (the line of
+ * the enclosing statement) and by function, along with the kind of the
+ * node evaluated just before it. Disabled, it costs the interpreter one
+ * branch per node.
+ * */
+class ExecutionCounts
+{
+public:
+    ExecutionCounts() = delete;
+
+    static inline bool enabled = false;
+
+    static void count(const std::type_info & kind, std::size_t line, FunctionStmt* function);
+
+    // per function and kind tables, the 'top' most frequent pairs of kinds and the annotated source.
+    static void report(std::ostream & out, std::string_view source, std::size_t top);
+};
+
+
+#endif //LOXPLUS_EXECUTIONCOUNTS_H
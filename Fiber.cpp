@@ -0,0 +1,360 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Fiber.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define LOXPLUS_FIBER_ASM 1
+#else
+#include <ucontext.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define LOXPLUS_ASAN 1
+#endif
+#if defined(__SANITIZE_THREAD__)
+#define LOXPLUS_TSAN 1
+#endif
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define LOXPLUS_ASAN 1
+#endif
+#if __has_feature(thread_sanitizer)
+#define LOXPLUS_TSAN 1
+#endif
+#endif
+
+#ifdef LOXPLUS_ASAN
+#include <sanitizer/asan_interface.h>
+#include <sanitizer/common_interface_defs.h>
+#endif
+#ifdef LOXPLUS_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+#ifdef LOXPLUS_FIBER_ASM
+extern "C" void loxplus_fiber_switch(void** from, void* to);
+extern "C" void loxplus_fiber_start();
+
+// saves the callee-saved registers and the floating-point control words on
+// the stack being left, stores its pointer in '*from' and restores the same
+// from 'to'. A new stack is entered with its entry in r13 and argument in r12.
+asm(R"(
+    .text
+    .p2align 4
+    .globl loxplus_fiber_switch
+    .type loxplus_fiber_switch, @function
+loxplus_fiber_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size loxplus_fiber_switch, .-loxplus_fiber_switch
+
+    .p2align 4
+    .globl loxplus_fiber_start
+    .type loxplus_fiber_start, @function
+loxplus_fiber_start:
+    .cfi_startproc
+    .cfi_undefined rip
+    movq %r12, %rdi
+    callq *%r13
+    ud2
+    .cfi_endproc
+    .size loxplus_fiber_start, .-loxplus_fiber_start
+)");
+#endif
+
+namespace
+{
+    // reserved like a thread's stack, only the pages touched take memory.
+    std::size_t stackSize = 2 * 1024 * 1024;
+    // room for the entry's frames and the margin callers keep below their stack limit.
+    constexpr std::size_t minimumStackSize = 128 * 1024;
+    // released stacks kept for the next fibers, with the top of them still faulted in.
+    constexpr std::size_t pooledStacks = 8;
+    constexpr std::size_t keptBytes = 64 * 1024;
+
+    const std::size_t guardSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<char*> freeStacks;
+
+    std::vector<Fiber*> fibers;
+    Fiber* running = nullptr;
+    // the thread's stack pointer, while a fiber runs.
+    void* threadStackPointer = nullptr;
+#ifndef LOXPLUS_FIBER_ASM
+    ucontext_t threadContext;
+#endif
+
+    // the guard page below the stack faults instead of overwriting another mapping.
+    char* acquireStack()
+    {
+        // each stack takes two mappings, thirty thousand fibers or so reach the default vm.max_map_count.
+        if (!freeStacks.empty())
+        {
+            auto mapping = freeStacks.back();
+            freeStacks.pop_back();
+            return mapping;
+        }
+
+        auto memory = mmap(nullptr, guardSize + stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (memory == MAP_FAILED) throw std::bad_alloc();
+        if (mprotect(memory, guardSize, PROT_NONE) != 0)
+        {
+            munmap(memory, guardSize + stackSize);
+            throw std::bad_alloc();
+        }
+
+        return static_cast<char*>(memory);
+    }
+
+    void releaseStack(char* mapping, std::size_t size)
+    {
+#ifdef LOXPLUS_ASAN
+        // a fiber dropped while suspended leaves its frames poisoned.
+        ASAN_UNPOISON_MEMORY_REGION(mapping + guardSize, size);
+#endif
+        if (size == stackSize && freeStacks.size() < pooledStacks)
+        {
+            // a deep recursion may have faulted in most of it.
+            madvise(mapping + guardSize, size - keptBytes, MADV_DONTNEED);
+            freeStacks.push_back(mapping);
+        }
+        else
+        {
+            munmap(mapping, guardSize + size);
+        }
+    }
+}
+
+Fiber::Fiber(Entry entry, void* argument)
+    : entry { entry }, argument { argument }, mapping { acquireStack() }, size { stackSize }
+{
+    bottom = mapping + guardSize;
+    top = mapping + guardSize + size;
+
+#ifdef LOXPLUS_FIBER_ASM
+    // what loxplus_fiber_switch pops, then 16 bytes keeping the entry's frame aligned.
+    auto frame = reinterpret_cast<std::uint64_t*>(top) - 10;
+    frame[0] = 0x1F80 | (std::uint64_t { 0x037F } << 32);
+    frame[1] = 0;
+    frame[2] = 0;
+    frame[3] = reinterpret_cast<std::uint64_t>(&Fiber::main);
+    frame[4] = reinterpret_cast<std::uint64_t>(this);
+    frame[5] = 0;
+    frame[6] = 0;
+    frame[7] = reinterpret_cast<std::uint64_t>(&loxplus_fiber_start);
+    frame[8] = 0;
+    frame[9] = 0;
+    stackPointer = frame;
+#else
+    // the context lives at the top of the stack, the fiber starts below it.
+    top -= (sizeof(ucontext_t) + 15) / 16 * 16;
+    auto context = reinterpret_cast<ucontext_t*>(top);
+    getcontext(context);
+    context->uc_stack.ss_sp = mapping + guardSize;
+    context->uc_stack.ss_size = top - bottom;
+    context->uc_link = nullptr;
+    makecontext(context, +[] { main(running); }, 0);
+    stackPointer = top;
+#endif
+
+#ifdef LOXPLUS_TSAN
+    sanitizerFiber = __tsan_create_fiber(0);
+#endif
+
+    index = fibers.size();
+    fibers.push_back(this);
+}
+
+Fiber::~Fiber()
+{
+    fibers[index] = fibers.back();
+    fibers[index]->index = index;
+    fibers.pop_back();
+
+#ifdef LOXPLUS_TSAN
+    __tsan_destroy_fiber(sanitizerFiber);
+#endif
+    releaseStack(mapping, size);
+}
+
+void Fiber::resume()
+{
+    if (done || active) return;
+
+    caller = running;
+    running = this;
+    active = true;
+
+#ifdef LOXPLUS_ASAN
+    void* fakeStack = nullptr;
+    __sanitizer_start_switch_fiber(&fakeStack, bottom, top - bottom);
+#endif
+#ifdef LOXPLUS_TSAN
+    callerFiber = __tsan_get_current_fiber();
+    __tsan_switch_to_fiber(sanitizerFiber, 0);
+#endif
+
+    transfer(caller, this);
+
+#ifdef LOXPLUS_ASAN
+    __sanitizer_finish_switch_fiber(fakeStack, nullptr, nullptr);
+#endif
+
+    active = false;
+    running = caller;
+    if (error) std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+void Fiber::suspend()
+{
+    auto fiber = running;
+    if (fiber == nullptr) return;
+
+#ifdef LOXPLUS_ASAN
+    void* fakeStack = nullptr;
+    __sanitizer_start_switch_fiber(&fakeStack, fiber->callerBottom, fiber->callerSize);
+#endif
+#ifdef LOXPLUS_TSAN
+    __tsan_switch_to_fiber(fiber->callerFiber, 0);
+#endif
+
+    transfer(fiber, fiber->caller);
+
+#ifdef LOXPLUS_ASAN
+    // resumed, maybe from another stack than the previous time.
+    __sanitizer_finish_switch_fiber(fakeStack, &fiber->callerBottom, &fiber->callerSize);
+#endif
+}
+
+void Fiber::setStackSize(std::size_t bytes)
+{
+    bytes = std::max(bytes, minimumStackSize);
+    bytes = (bytes + guardSize - 1) / guardSize * guardSize;
+    if (bytes == stackSize) return;
+
+    // the pooled stacks have the previous size.
+    for (auto stack : freeStacks)
+    {
+        munmap(stack, guardSize + stackSize);
+    }
+    freeStacks.clear();
+    stackSize = bytes;
+}
+
+Fiber* Fiber::current()
+{
+    return running;
+}
+
+const char* Fiber::runningStackTop(const char* threadTop)
+{
+    return running != nullptr ? running->top : threadTop;
+}
+
+std::vector<Fiber::StackRange> Fiber::resumingStacks(const char* threadTop)
+{
+    std::vector<StackRange> stacks;
+    for (auto fiber = running; fiber != nullptr; fiber = fiber->caller)
+    {
+        if (fiber->caller != nullptr)
+        {
+            stacks.emplace_back(static_cast<const char*>(fiber->caller->stackPointer), fiber->caller->top);
+        }
+        else
+        {
+            stacks.emplace_back(static_cast<const char*>(threadStackPointer), threadTop);
+        }
+    }
+
+    return stacks;
+}
+
+std::vector<Fiber::StackRange> Fiber::suspendedStacks()
+{
+    std::vector<StackRange> stacks;
+    for (auto fiber : fibers)
+    {
+        if (!fiber->active && !fiber->done)
+        {
+            stacks.emplace_back(static_cast<const char*>(fiber->stackPointer), fiber->top);
+        }
+    }
+
+    return stacks;
+}
+
+void Fiber::main(void* argument)
+{
+    auto fiber = static_cast<Fiber*>(argument);
+#ifdef LOXPLUS_ASAN
+    __sanitizer_finish_switch_fiber(nullptr, &fiber->callerBottom, &fiber->callerSize);
+#endif
+
+    // nothing may unwind past the first frame of the stack.
+    try
+    {
+        fiber->entry(fiber->argument);
+    }
+    catch (...)
+    {
+        fiber->error = std::current_exception();
+    }
+    fiber->done = true;
+
+#ifdef LOXPLUS_ASAN
+    __sanitizer_start_switch_fiber(nullptr, fiber->callerBottom, fiber->callerSize);
+#endif
+#ifdef LOXPLUS_TSAN
+    __tsan_switch_to_fiber(fiber->callerFiber, 0);
+#endif
+
+    transfer(fiber, fiber->caller);
+    std::abort();
+}
+
+#ifdef LOXPLUS_FIBER_ASM
+void Fiber::transfer(Fiber* from, Fiber* to)
+{
+    auto saved = from != nullptr ? &from->stackPointer : &threadStackPointer;
+    loxplus_fiber_switch(saved, to != nullptr ? to->stackPointer : threadStackPointer);
+}
+#else
+[[gnu::noinline]] void Fiber::transfer(Fiber* from, Fiber* to)
+{
+    // the callee-saved registers are spilled in this frame, above the saved stack pointer.
+    __builtin_unwind_init();
+    char marker;
+    (from != nullptr ? from->stackPointer : threadStackPointer) = &marker;
+
+    auto context = [](Fiber* fiber) {
+        return fiber != nullptr ? reinterpret_cast<ucontext_t*>(fiber->top) : &threadContext;
+    };
+    swapcontext(context(from), context(to));
+}
+#endif
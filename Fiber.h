@@ -0,0 +1,91 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_FIBER_H
+#define LOXPLUS_FIBER_H
+
+#include <cstddef>
+#include <exception>
+#include <utility>
+#include <vector>
+
+/*
+ * Native stack of its own, on which a function runs until it suspends
+ * itself, to be resumed later where it stopped. Switching saves the
+ * callee-saved registers on the stack being left and loads the stack
+ * pointer of the other one, on x86-64 it costs about a function call;
+ * elsewhere it goes through swapcontext(), which also saves the signal
+ * mask with a system call.
+ *
+ * The stacks are reserved without being committed, behind a guard page,
+ * so a fiber costs the pages it touched and two mappings.
+ *
+ * A fiber destroyed while suspended is dropped without unwinding it, the
+ * frames it holds are never returned to.
+ * */
+class Fiber
+{
+public:
+    using Entry = void (*)(void* argument);
+    // [low, high) bounds of a native stack.
+    using StackRange = std::pair<const char*, const char*>;
+
+    Fiber(Entry entry, void* argument);
+    ~Fiber();
+
+    Fiber(const Fiber &) = delete;
+    Fiber & operator=(const Fiber &) = delete;
+
+    // runs the fiber until it suspends or returns, rethrows what escaped from its entry.
+    void resume();
+    // from the running fiber, back to the one that resumed it.
+    static void suspend();
+
+    // of the stacks of the fibers created from now on, rounded up to whole pages.
+    static void setStackSize(std::size_t bytes);
+
+    bool finished() const { return done; }
+    // lowest address of its stack.
+    const char* stackLimit() const { return bottom; }
+
+    // the fiber running, nullptr when it is the thread's own stack.
+    static Fiber* current();
+    // top of the stack in use, 'threadTop' when no fiber runs.
+    static const char* runningStackTop(const char* threadTop);
+    // stacks waiting for a fiber they resumed to suspend, the thread's one included.
+    static std::vector<StackRange> resumingStacks(const char* threadTop);
+    // stacks of the fibers suspended, or not started yet.
+    static std::vector<StackRange> suspendedStacks();
+
+private:
+    Entry entry;
+    void* argument;
+
+    char* mapping;
+    std::size_t size;
+    const char* bottom;
+    char* top;
+    // saved when switching away from the fiber, its live frames are above it.
+    void* stackPointer = nullptr;
+
+    // the fiber that resumed this one, nullptr for the thread.
+    Fiber* caller = nullptr;
+    // running, or waiting for a fiber it resumed.
+    bool active = false;
+    bool done = false;
+    std::exception_ptr error;
+    // position in the list of fibers.
+    std::size_t index;
+
+    // where the sanitizers switch back to.
+    const void* callerBottom = nullptr;
+    std::size_t callerSize = 0;
+    void* callerFiber = nullptr;
+    void* sanitizerFiber = nullptr;
+
+    [[noreturn]] static void main(void* fiber);
+    static void transfer(Fiber* from, Fiber* to);
+};
+
+#endif //LOXPLUS_FIBER_H
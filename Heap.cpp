@@ -0,0 +1,802 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Heap.h"
+#include "Fiber.h"
+#include "Interpreter.h"
+#include "Object.h"
+#include "Stats.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csetjmp>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace
+{
+    // precedes every object, in the nursery as well as in the old generation.
+    struct Header
+    {
+        // of the object, the cell is rounded up to the alignment.
+        std::uint32_t size;
+        std::uint32_t unused;
+        // where a minor collection moved the object, itself when it was pinned.
+        HeapObject* forward;
+    };
+
+    constexpr std::size_t alignment = alignof(std::max_align_t);
+    static_assert(sizeof(Header) % alignment == 0);
+
+    constexpr std::size_t nurserySize = 2 * 1024 * 1024;
+    constexpr std::size_t minimumMajorThreshold = 8 * 1024 * 1024;
+
+    // part of the nursery between two pinned objects.
+    struct Gap
+    {
+        char* begin;
+        char* end;
+        // end of the cells allocated in it.
+        char* used;
+    };
+
+    char* nursery = nullptr;
+    std::vector<Gap> gaps;
+    std::size_t currentGap = 0;
+    char* top = nullptr;
+    char* limit = nullptr;
+
+    // malloc'ed objects, sorted by address up to 'sortedCells', and the
+    // pinned ones left in the nursery, sorted.
+    std::vector<Header*> oldCells;
+    std::size_t sortedCells = 0;
+    std::vector<Header*> pinnedCells;
+    std::size_t oldBytes = 0;
+    std::size_t majorThreshold = minimumMajorThreshold;
+    // bytes ever added to the old generation, by promotions or directly.
+    std::size_t grownBytes = 0;
+
+    std::vector<HeapObject*> remembered;
+
+    // a major collection is either idle, marking or sweeping.
+    enum class Phase { Idle, Marking, Sweeping };
+    Phase phase = Phase::Idle;
+    // marked objects whose fields have not been scanned.
+    std::vector<HeapObject*> grey;
+    // marked unmanaged objects, unmarked once the marking ends.
+    std::vector<HeapObject*> markedUnmanaged;
+    // the cells before 'sweepKept' survived, the ones to sweep are from the
+    // cursor to 'sweepEnd', those promoted since are after it.
+    std::size_t sweepKept = 0;
+    std::size_t sweepCursor = 0;
+    std::size_t sweepEnd = 0;
+    // survivors among the first 'sortedCells', the cells promoted during the marking are not sorted.
+    std::size_t sweepSorted = 0;
+    // bytes of the old objects the marking reached, what the next threshold is set from.
+    std::size_t markedBytes = 0;
+
+    // the marking, then the sweeping, has to be done before the old generation grew by a quarter of
+    // what it held when the collection started, whatever the slices, so each one does its share of
+    // 'pacingTotal' units of work for the bytes grown since 'pacingStart'.
+    std::size_t cycleBytes = 0;
+    std::size_t pacingStart = 0;
+    std::size_t pacingTotal = 0;
+    std::size_t pacingDone = 0;
+
+    constexpr std::size_t sliceBytes = 64 * 1024;
+    std::size_t sliceBudget = 0;
+    // objects swept by each slice of the allocator, when no budget was set.
+    constexpr std::size_t lazySweepBudget = 1024;
+    bool nurseryFull = false;
+    // the pinned objects left too little of the nursery for a minor collection to be worth it,
+    // the allocator goes to the old generation until a major one released some of them.
+    bool nurseryClogged = false;
+    std::size_t cloggedBytes = 0;
+
+    bool concurrent = false;
+    std::thread marker;
+    // taken by the marker for each slice, and by the interpreter to modify the heap while it runs.
+    std::mutex markerLock;
+    std::atomic<bool> markerDone { false };
+    // objects the marker scans before letting the interpreter in.
+    constexpr std::size_t markerSlice = 64;
+
+    Interpreter* attached = nullptr;
+    const char* stackTop = nullptr;
+
+    Heap::Statistics totals;
+
+    std::size_t cellSize(std::size_t size)
+    {
+        return sizeof(Header) + (size + alignment - 1) / alignment * alignment;
+    }
+
+    Header* headerOf(HeapObject* object)
+    {
+        return reinterpret_cast<Header*>(object) - 1;
+    }
+
+    HeapObject* objectOf(Header* header)
+    {
+        return reinterpret_cast<HeapObject*>(header + 1);
+    }
+
+    bool inNursery(const void* address)
+    {
+        auto value = reinterpret_cast<std::uintptr_t>(address);
+        auto begin = reinterpret_cast<std::uintptr_t>(nursery);
+        return value >= begin && value < begin + nurserySize;
+    }
+
+    void* allocateOld(std::size_t size)
+    {
+        auto header = static_cast<Header*>(std::malloc(cellSize(size)));
+        if (header == nullptr) throw std::bad_alloc();
+
+        header->size = static_cast<std::uint32_t>(size);
+        header->forward = nullptr;
+        oldCells.push_back(header);
+        oldBytes += cellSize(size);
+        grownBytes += cellSize(size);
+
+        return header + 1;
+    }
+
+    // the nursery, minus the pinned objects living in it.
+    void resetNursery()
+    {
+        std::sort(pinnedCells.begin(), pinnedCells.end());
+
+        gaps.clear();
+        auto begin = nursery;
+        for (auto header : pinnedCells)
+        {
+            auto cell = reinterpret_cast<char*>(header);
+            if (cell > begin) gaps.push_back({ begin, cell, begin });
+            begin = cell + cellSize(header->size);
+        }
+        if (begin < nursery + nurserySize) gaps.push_back({ begin, nursery + nurserySize, begin });
+        if (gaps.empty()) gaps.push_back({ begin, begin, begin });
+
+        currentGap = 0;
+        top = gaps[0].begin;
+        limit = gaps[0].end;
+    }
+
+    template <typename Function>
+    void forEachYoungCell(Function function)
+    {
+        gaps[currentGap].used = top;
+        for (std::size_t i = 0; i <= currentGap; i++)
+        {
+            for (auto cell = gaps[i].begin; cell < gaps[i].used; cell += cellSize(reinterpret_cast<Header*>(cell)->size))
+            {
+                function(reinterpret_cast<Header*>(cell));
+            }
+        }
+    }
+
+    // it reads whole frames, padding and sanitizer red zones included.
+    [[gnu::no_sanitize_address]] void scanStack(const char* bottom, const char* top, bool nurseryOnly, std::vector<std::uintptr_t> & words)
+    {
+        bottom += (alignof(void*) - reinterpret_cast<std::uintptr_t>(bottom) % alignof(void*)) % alignof(void*);
+        for (auto word = bottom; word + sizeof(void*) <= top; word += sizeof(void*))
+        {
+            auto value = *reinterpret_cast<const std::uintptr_t*>(word);
+            if (!nurseryOnly || inNursery(reinterpret_cast<const void*>(value))) words.push_back(value);
+        }
+    }
+
+    // words of the native stacks that may be references, sorted. The
+    // callee-saved registers are spilled first: they may hold the only one.
+    // the stacks of the suspended fibers only pin what they reference: what
+    // they use is reachable from their generator, which must not keep itself alive.
+    [[gnu::noinline, gnu::no_sanitize_address]] std::vector<std::uintptr_t> stackWords(bool nurseryOnly)
+    {
+        std::jmp_buf registers;
+#if defined(__GNUC__)
+        __builtin_unwind_init();
+#endif
+        setjmp(registers);
+
+        std::vector<std::uintptr_t> words;
+        scanStack(reinterpret_cast<const char*>(&registers), Fiber::runningStackTop(stackTop), nurseryOnly, words);
+        for (auto [bottom, top] : Fiber::resumingStacks(stackTop))
+        {
+            scanStack(bottom, top, nurseryOnly, words);
+        }
+        if (nurseryOnly)
+        {
+            for (auto [bottom, top] : Fiber::suspendedStacks())
+            {
+                scanStack(bottom, top, nurseryOnly, words);
+            }
+        }
+
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        return words;
+    }
+
+    bool contains(Header* header, std::uintptr_t address)
+    {
+        auto begin = reinterpret_cast<std::uintptr_t>(header);
+        return address >= begin && address < begin + cellSize(header->size);
+    }
+
+    // the cell of 'cells', sorted, containing 'address'.
+    Header* findCell(const std::vector<Header*> & cells, std::uintptr_t address)
+    {
+        auto it = std::upper_bound(cells.begin(), cells.end(), address, [](std::uintptr_t address, Header* header) {
+            return address < reinterpret_cast<std::uintptr_t>(header);
+        });
+        return it != cells.begin() && contains(*(it - 1), address) ? *(it - 1) : nullptr;
+    }
+
+    void startPacing(std::size_t total)
+    {
+        pacingStart = grownBytes;
+        pacingTotal = total;
+        pacingDone = 0;
+    }
+
+    std::size_t pacingAllowance()
+    {
+        return std::max(minimumMajorThreshold, cycleBytes) / 4;
+    }
+
+    bool pacingLate()
+    {
+        return grownBytes - pacingStart >= pacingAllowance();
+    }
+
+    // the work a slice does to stay on schedule, 'budget' at least, all of it once late.
+    std::size_t pacedBudget(std::size_t budget)
+    {
+        if (pacingLate()) return SIZE_MAX;
+
+        auto due = pacingTotal * (grownBytes - pacingStart) / pacingAllowance();
+        return std::max(budget, due > pacingDone ? due - pacingDone : 0);
+    }
+
+    // stops the bump allocation after another slice worth of bytes, while a major collection runs.
+    void scheduleSlice()
+    {
+        auto end = gaps[currentGap].end;
+        limit = phase != Phase::Idle && static_cast<std::size_t>(end - top) > sliceBytes ? top + sliceBytes : end;
+    }
+
+    void recordPause(std::chrono::steady_clock::time_point start)
+    {
+        std::chrono::duration<double, std::milli> pause = std::chrono::steady_clock::now() - start;
+        totals.pauseMilliseconds += pause.count();
+        totals.maxPauseMilliseconds = std::max(totals.maxPauseMilliseconds, pause.count());
+
+        std::size_t bucket = 0;
+        while (bucket + 1 < Heap::pauseBuckets && pause.count() * 1000 >= Heap::pauseBucketLimit(bucket)) bucket++;
+        totals.pauses[bucket]++;
+    }
+}
+
+// copies the young objects it reaches to the old generation.
+class Heap::MinorTracer : public Tracer
+{
+public:
+    std::vector<HeapObject*> worklist;
+    std::vector<HeapObject*> unmanaged;
+
+protected:
+    void visit(HeapObject*& object) override
+    {
+        if (!inNursery(object))
+        {
+            // the frame instances are roots, their fields still have to be scanned.
+            if ((flags(object) & (Managed | Visited)) == 0)
+            {
+                flags(object) |= Visited;
+                unmanaged.push_back(object);
+                worklist.push_back(object);
+            }
+            return;
+        }
+
+        auto header = headerOf(object);
+        if (header->forward != nullptr)
+        {
+            object = header->forward;
+            return;
+        }
+        if (flags(object) & Old) return;
+
+        auto copy = object->relocate(allocateOld(header->size));
+        flags(copy) = Managed | Old;
+        object->~HeapObject();
+        header->forward = copy;
+        promoted(copy);
+
+        totals.promotedBytes += cellSize(header->size);
+        object = copy;
+        worklist.push_back(copy);
+    }
+};
+
+// greys the objects it reaches.
+class Heap::MarkTracer : public Tracer
+{
+protected:
+    void visit(HeapObject*& object) override
+    {
+        shade(object);
+    }
+};
+
+void* Heap::allocateCell(std::size_t size)
+{
+    if (nursery == nullptr)
+    {
+        nursery = static_cast<char*>(std::aligned_alloc(alignment, nurserySize));
+        if (nursery == nullptr) throw std::bad_alloc();
+        resetNursery();
+    }
+    totals.allocatedObjects++;
+
+    auto bytes = cellSize(size);
+    while (static_cast<std::size_t>(limit - top) < bytes)
+    {
+        if (limit != gaps[currentGap].end)
+        {
+            // allocated enough since the previous slice, sweeping needs no safepoint.
+            limit = gaps[currentGap].end;
+            if (phase == Phase::Sweeping)
+            {
+                auto start = std::chrono::steady_clock::now();
+                sweepSlice(pacedBudget(sliceBudget == 0 ? lazySweepBudget : sliceBudget));
+                scheduleSlice();
+                recordPause(start);
+            }
+            else
+            {
+                collectionPending = true;
+            }
+            continue;
+        }
+
+        if (currentGap + 1 == gaps.size())
+        {
+            if (nurseryClogged && !(phase == Phase::Idle && oldBytes >= majorThreshold))
+            {
+                // the collections in progress still need their slices.
+                cloggedBytes += bytes;
+                if (cloggedBytes >= sliceBytes && phase != Phase::Idle)
+                {
+                    cloggedBytes = 0;
+                    collectionPending = true;
+                }
+                return allocateOld(size);
+            }
+
+            // too late to collect, the caller may hold references the collector cannot see.
+            nurseryFull = true;
+            collectionPending = true;
+            return allocateOld(size);
+        }
+
+        // the slices go on in the next gap.
+        gaps[currentGap].used = top;
+        currentGap++;
+        top = gaps[currentGap].begin;
+        scheduleSlice();
+    }
+
+    auto header = reinterpret_cast<Header*>(top);
+    header->size = static_cast<std::uint32_t>(size);
+    header->forward = nullptr;
+    top += bytes;
+
+    return header + 1;
+}
+
+void Heap::adopt(HeapObject* object)
+{
+    if (inNursery(object))
+    {
+        flags(object) = Managed;
+    }
+    else
+    {
+        // its constructor may have stored young references.
+        flags(object) = Managed | Old | Remembered;
+        remembered.push_back(object);
+        promoted(object);
+    }
+}
+
+void Heap::lock()
+{
+    markerLock.lock();
+}
+
+void Heap::unlock()
+{
+    markerLock.unlock();
+}
+
+void Heap::recordWrite(HeapObject* owner, const Object & previous, const Object & value)
+{
+    // what the snapshot could reach stays reachable for the marking.
+    if (marking)
+    {
+        if (auto object = previous.heapObject()) shade(object);
+    }
+
+    auto object = value.heapObject();
+    if (object != nullptr && (flags(object) & (Managed | Old)) == Managed)
+    {
+        rememberObject(owner);
+    }
+}
+
+void Heap::remember(HeapObject* owner)
+{
+    Mutation mutation { owner };
+    rememberObject(owner);
+}
+
+void Heap::rememberObject(HeapObject* owner)
+{
+    if ((flags(owner) & (Managed | Old | Remembered)) == (Managed | Old))
+    {
+        flags(owner) |= Remembered;
+        remembered.push_back(owner);
+    }
+}
+
+void Heap::shade(HeapObject* object)
+{
+    // the young objects are left to the minor collections.
+    if ((flags(object) & Marked) || (flags(object) & (Managed | Old)) == Managed) return;
+
+    flags(object) |= Marked;
+    if ((flags(object) & Managed) == 0) markedUnmanaged.push_back(object);
+    else markedBytes += cellSize(headerOf(object)->size);
+    grey.push_back(object);
+}
+
+void Heap::shadeFields(HeapObject* object)
+{
+    MarkTracer tracer;
+    object->trace(tracer);
+}
+
+void Heap::promoted(HeapObject* object)
+{
+    // black: it did not exist when the snapshot was taken, what it references did.
+    if (marking) flags(object) |= Marked;
+}
+
+void Heap::attach(Interpreter* interpreter)
+{
+    joinMarker();
+
+    attached = interpreter;
+    stackTop = nullptr;
+
+#ifdef __linux__
+    pthread_attr_t attributes;
+    if (interpreter != nullptr && pthread_getattr_np(pthread_self(), &attributes) == 0)
+    {
+        void* address;
+        std::size_t size;
+        if (pthread_attr_getstack(&attributes, &address, &size) == 0)
+        {
+            stackTop = static_cast<const char*>(address) + size;
+        }
+        pthread_attr_destroy(&attributes);
+    }
+#endif
+}
+
+void Heap::collect()
+{
+    collectionPending = false;
+
+    // without the bounds of the native stack, some roots would be missed.
+    if (attached == nullptr || stackTop == nullptr || nursery == nullptr) return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (nurseryFull)
+    {
+        nurseryFull = false;
+        minor();
+
+        // right after a minor collection, the snapshot holds no young object.
+        if (phase == Phase::Idle && oldBytes >= majorThreshold) startMarking();
+    }
+
+    if (phase == Phase::Marking)
+    {
+        if (concurrent)
+        {
+            // a marker falling behind is waited for.
+            if (markerDone || pacingLate()) finishMarking();
+        }
+        else if (markSlice(sliceBudget == 0 ? SIZE_MAX : pacedBudget(sliceBudget)))
+        {
+            finishMarking();
+        }
+    }
+    // the allocator sweeps the rest, unless the nursery is too fragmented to reach its slices.
+    if (phase == Phase::Sweeping)
+    {
+        sweepSlice(sliceBudget == 0 ? (concurrent ? pacedBudget(lazySweepBudget) : SIZE_MAX) : pacedBudget(sliceBudget));
+    }
+    scheduleSlice();
+
+    recordPause(start);
+}
+
+void Heap::minor()
+{
+    totals.minorCollections++;
+
+    // the marker may be scanning the old objects whose references get updated.
+    std::unique_lock<std::mutex> guard { markerLock, std::defer_lock };
+    if (markerRunning) guard.lock();
+
+    MinorTracer tracer;
+
+    // the young objects the native stack may reference stay where they are.
+    auto words = stackWords(true);
+    auto word = words.begin();
+    forEachYoungCell([&](Header* header) {
+        auto begin = reinterpret_cast<std::uintptr_t>(header);
+        while (word != words.end() && *word < begin) ++word;
+        if (word == words.end() || !contains(header, *word)) return;
+
+        auto object = objectOf(header);
+        flags(object) |= Old;
+        header->forward = object;
+        pinnedCells.push_back(header);
+        oldBytes += cellSize(header->size);
+        grownBytes += cellSize(header->size);
+        totals.pinnedObjects++;
+        promoted(object);
+        tracer.worklist.push_back(object);
+    });
+
+    attached->traceRoots(tracer);
+
+    for (auto object : remembered)
+    {
+        flags(object) &= ~Remembered;
+        object->trace(tracer);
+    }
+    remembered.clear();
+
+    while (!tracer.worklist.empty())
+    {
+        auto object = tracer.worklist.back();
+        tracer.worklist.pop_back();
+        object->trace(tracer);
+    }
+
+    for (auto object : tracer.unmanaged)
+    {
+        flags(object) &= ~Visited;
+    }
+
+    // what was neither copied nor pinned is dead.
+    std::size_t released = 0, releasedBytes = 0;
+    forEachYoungCell([&](Header* header) {
+        auto object = objectOf(header);
+        if (header->forward == nullptr)
+        {
+            released++;
+            releasedBytes += header->size;
+            object->~HeapObject();
+        }
+        else if (header->forward == object)
+        {
+            header->forward = nullptr;
+        }
+    });
+    if (Stats::enabled) Stats::released(released, releasedBytes);
+
+    resetNursery();
+
+    // like the ones the stacks of thousands of suspended generators keep alive.
+    std::size_t free = 0;
+    for (auto & gap : gaps) free += gap.end - gap.begin;
+    nurseryClogged = free < nurserySize / 4;
+    cloggedBytes = 0;
+}
+
+void Heap::startMarking()
+{
+    phase = Phase::Marking;
+    marking = true;
+    markedBytes = 0;
+    cycleBytes = oldBytes;
+    // each old object is scanned once at most, the ones promoted meanwhile are not.
+    startPacing(oldCells.size() + pinnedCells.size());
+    markRoots();
+
+    if (concurrent)
+    {
+        markerDone = false;
+        markerRunning = true;
+        marker = std::thread { markConcurrently };
+    }
+}
+
+void Heap::markRoots()
+{
+    MarkTracer tracer;
+
+    // only the cells promoted since the previous time need sorting.
+    std::sort(oldCells.begin() + sortedCells, oldCells.end());
+    std::inplace_merge(oldCells.begin(), oldCells.begin() + sortedCells, oldCells.end());
+    sortedCells = oldCells.size();
+
+    for (auto word : stackWords(false))
+    {
+        if (auto header = findCell(oldCells, word)) shade(objectOf(header));
+        else if (auto pinned = findCell(pinnedCells, word)) shade(objectOf(pinned));
+    }
+
+    attached->traceRoots(tracer);
+}
+
+bool Heap::markSlice(std::size_t budget)
+{
+    MarkTracer tracer;
+
+    std::size_t work = 0;
+    for (; work < budget && !grey.empty(); work++)
+    {
+        auto object = grey.back();
+        grey.pop_back();
+        object->trace(tracer);
+    }
+    pacingDone += work;
+
+    return grey.empty();
+}
+
+void Heap::markConcurrently()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (bool done = false; !done; )
+    {
+        std::lock_guard<std::mutex> guard { markerLock };
+        done = markSlice(markerSlice);
+    }
+
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    totals.concurrentMarkMilliseconds += duration.count();
+    markerDone = true;
+}
+
+void Heap::joinMarker()
+{
+    if (marker.joinable()) marker.join();
+    markerRunning = false;
+}
+
+void Heap::finishMarking()
+{
+    // the barrier may have greyed objects since the marker ran out of them.
+    joinMarker();
+    markSlice(SIZE_MAX);
+
+    marking = false;
+    for (auto object : markedUnmanaged)
+    {
+        flags(object) &= ~Marked;
+    }
+    markedUnmanaged.clear();
+
+    // the memory of the dead pinned objects returns to the nursery with the next minor collection.
+    std::size_t released = 0, releasedBytes = 0;
+    pinnedCells.erase(std::remove_if(pinnedCells.begin(), pinnedCells.end(), [&](Header* header) {
+        auto object = objectOf(header);
+        if (flags(object) & Marked)
+        {
+            flags(object) &= ~Marked;
+            return false;
+        }
+
+        if (flags(object) & Remembered)
+        {
+            remembered.erase(std::find(remembered.begin(), remembered.end(), object));
+        }
+
+        released++;
+        releasedBytes += header->size;
+        oldBytes -= cellSize(header->size);
+        object->~HeapObject();
+        return true;
+    }), pinnedCells.end());
+    if (Stats::enabled) Stats::released(released, releasedBytes);
+    nurseryClogged = false;
+
+    phase = Phase::Sweeping;
+    sweepKept = 0;
+    sweepSorted = 0;
+    sweepCursor = 0;
+    sweepEnd = oldCells.size();
+    startPacing(sweepEnd);
+}
+
+void Heap::sweepSlice(std::size_t budget)
+{
+    std::size_t released = 0, releasedBytes = 0;
+    pacingDone += std::min(budget, sweepEnd - sweepCursor);
+    for (std::size_t work = 0; work < budget && sweepCursor < sweepEnd; work++)
+    {
+        auto sorted = sweepCursor < sortedCells;
+        auto header = oldCells[sweepCursor++];
+        auto object = objectOf(header);
+        if (flags(object) & Marked)
+        {
+            flags(object) &= ~Marked;
+            oldCells[sweepKept++] = header;
+            if (sorted) sweepSorted++;
+            continue;
+        }
+
+        // it may have been remembered after the last minor collection.
+        if (flags(object) & Remembered)
+        {
+            remembered.erase(std::find(remembered.begin(), remembered.end(), object));
+        }
+
+        released++;
+        releasedBytes += header->size;
+        oldBytes -= cellSize(header->size);
+        object->~HeapObject();
+        std::free(header);
+    }
+    if (Stats::enabled) Stats::released(released, releasedBytes);
+
+    if (sweepCursor == sweepEnd)
+    {
+        // the survivors keep their order.
+        oldCells.erase(oldCells.begin() + sweepKept, oldCells.begin() + sweepEnd);
+        sortedCells = sweepSorted;
+
+        phase = Phase::Idle;
+        // the objects promoted during the collection are not counted, they may as well be garbage.
+        majorThreshold = std::max(minimumMajorThreshold, 2 * markedBytes);
+        totals.majorCollections++;
+    }
+}
+
+void Heap::setSliceBudget(std::size_t objects)
+{
+    sliceBudget = objects;
+}
+
+void Heap::setConcurrent(bool enabled)
+{
+    concurrent = enabled;
+}
+
+const Heap::Statistics & Heap::statistics()
+{
+    return totals;
+}
+
+std::size_t Heap::pauseBucketLimit(std::size_t bucket)
+{
+    return std::size_t { 16 } << bucket;
+}
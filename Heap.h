@@ -0,0 +1,171 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_HEAP_H
+#define LOXPLUS_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "HeapObject.h"
+#include "Object.h"
+
+class Interpreter;
+
+/*
+ * Generational heap of the runtime objects. They are bump-allocated in the
+ * nursery, a minor collection copies the survivors to the old generation
+ * and frees the whole nursery, so its cost is the live young objects only.
+ * The old generation is malloc'ed and collected by mark-sweep, once it is
+ * twice what the previous major collection found alive.
+ *
+ * Collections only happen at the interpreter's safepoint. The roots are
+ * the interpreter's ones, the old objects recorded by the write barrier,
+ * and the native stack of the interpreter thread: it is scanned
+ * conservatively and the young objects it may reference are pinned,
+ * promoted where they are instead of being copied. So are the stacks of
+ * the fibers running generators.
+ *
+ * The marking is snapshot-at-the-beginning: a major collection starts with
+ * a minor one and greys the roots, then the write barrier greys the
+ * objects being overwritten and the objects promoted meanwhile are black.
+ * It marks in a single pause, in slices interleaved with the script, or
+ * on a helper thread, and the allocator sweeps a few objects each time it
+ * allocated another few kilobytes. The slices are paced by what the old
+ * generation gained meanwhile, so the marking and the sweeping are each
+ * done before it grew by a quarter.
+ * */
+class Heap
+{
+public:
+    // pauses are counted by powers of two of microseconds, from 16 to 128ms and more.
+    static constexpr std::size_t pauseBuckets = 14;
+
+    struct Statistics
+    {
+        // objects allocated by allocate(), in the nursery or not.
+        std::size_t allocatedObjects = 0;
+        std::size_t minorCollections = 0;
+        std::size_t majorCollections = 0;
+        std::size_t promotedBytes = 0;
+        std::size_t pinnedObjects = 0;
+        double pauseMilliseconds = 0;
+        double maxPauseMilliseconds = 0;
+        std::size_t pauses[pauseBuckets] = {};
+        // from the start of the marking to the helper thread finishing it.
+        double concurrentMarkMilliseconds = 0;
+    };
+
+    // holds the heap while the fields of 'owner' are modified, they must be stored through it.
+    class Mutation
+    {
+    public:
+        explicit Mutation(HeapObject* owner)
+            : owner { owner }
+        {
+            if (markerRunning) lock();
+        }
+
+        ~Mutation()
+        {
+            if (markerRunning) unlock();
+        }
+
+        Mutation(const Mutation &) = delete;
+        Mutation & operator=(const Mutation &) = delete;
+
+        void store(Object & field, Object value)
+        {
+            if (marking || (owner->heapFlags & (Old | Remembered)) == Old) recordWrite(owner, field, value);
+            field = std::move(value);
+        }
+
+        // before all the fields of the owner are overwritten at once.
+        void discardFields()
+        {
+            if (marking) shadeFields(owner);
+        }
+
+    private:
+        HeapObject* owner;
+    };
+
+    Heap() = delete;
+
+    // set once the nursery is full, or a slice of a major collection is due.
+    static inline bool collectionPending = false;
+
+    template <typename T, typename... Args>
+    static T* allocate(Args&&... args)
+    {
+        auto object = new (allocateCell(sizeof(T))) T { std::forward<Args>(args)... };
+        adopt(object);
+        return object;
+    }
+
+    // 'owner' may reference young objects without going through a Mutation.
+    static void remember(HeapObject* owner);
+
+    // the interpreter whose roots are scanned, nothing is collected while none is attached.
+    static void attach(Interpreter* interpreter);
+    // to call at the safepoint only: a minor collection if the nursery is full, then the next step of a major one.
+    static void collect();
+
+    // objects marked or swept by each slice of a major collection, 0 collects in a single pause.
+    static void setSliceBudget(std::size_t objects);
+    // marks on a helper thread instead of in slices.
+    static void setConcurrent(bool concurrent);
+
+    static const Statistics & statistics();
+    // upper bound of a bucket, in microseconds, the last one has none.
+    static std::size_t pauseBucketLimit(std::size_t bucket);
+
+private:
+    enum Flags : std::uint8_t
+    {
+        Managed = 1,
+        Old = 2,
+        Remembered = 4,
+        Marked = 8,
+        // unmanaged objects already scanned by the current minor collection.
+        Visited = 16,
+    };
+
+    // a major collection is marking, the barrier greys the overwritten objects.
+    static inline bool marking = false;
+    // the helper thread may be marking, the heap is shared with it.
+    static inline bool markerRunning = false;
+
+    class MinorTracer;
+    class MarkTracer;
+
+    static std::uint8_t & flags(HeapObject* object) { return object->heapFlags; }
+
+    static void lock();
+    static void unlock();
+
+    static void* allocateCell(std::size_t size);
+    static void adopt(HeapObject* object);
+    static void recordWrite(HeapObject* owner, const Object & previous, const Object & value);
+    static void rememberObject(HeapObject* owner);
+
+    // greys an old or unmanaged object, if still white.
+    static void shade(HeapObject* object);
+    static void shadeFields(HeapObject* object);
+    // colours an object that just became old.
+    static void promoted(HeapObject* object);
+
+    static void minor();
+    static void startMarking();
+    static void markRoots();
+    // returns true once there is nothing grey left.
+    static bool markSlice(std::size_t budget);
+    static void markConcurrently();
+    static void joinMarker();
+    static void finishMarking();
+    static void sweepSlice(std::size_t budget);
+};
+
+
+#endif //LOXPLUS_HEAP_H
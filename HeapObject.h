@@ -0,0 +1,81 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_HEAPOBJECT_H
+#define LOXPLUS_HEAPOBJECT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <utility>
+
+class HeapObject;
+class Object;
+
+// visits the references held by a heap object, and may update them.
+class Tracer
+{
+public:
+    virtual ~Tracer() = default;
+
+    template <typename T>
+    void trace(T*& reference)
+    {
+        if (reference == nullptr) return;
+
+        HeapObject* object = reference;
+        visit(object);
+        // only written when moved: the concurrent marker must not store to the objects it reads.
+        if (object != reference) reference = static_cast<T*>(object);
+    }
+
+    void trace(Object & value);
+
+    // strings are values, owned by the object holding them.
+    virtual void visitString(const std::string & string) {}
+
+protected:
+    virtual void visit(HeapObject*& object) = 0;
+};
+
+/*
+ * Runtime values that Lox code can reference: environments, functions,
+ * classes and instances. It must be the first base class, so that the
+ * object and its HeapObject share the same address.
+ * */
+class HeapObject
+{
+public:
+    virtual ~HeapObject() = default;
+
+    virtual void trace(Tracer & tracer) = 0;
+    // the object and the memory it owns, roughly.
+    virtual std::size_t heapSize() const = 0;
+    virtual std::string describe() const = 0;
+    // moves the object into 'memory', the heap destroys the original.
+    virtual HeapObject* relocate(void* memory) = 0;
+
+protected:
+    template <typename T>
+    static HeapObject* moveTo(T & object, void* memory)
+    {
+        return new (memory) T { std::move(object) };
+    }
+
+    template <typename Map>
+    static std::size_t mapSize(const Map & map)
+    {
+        // red-black tree nodes: three pointers and the colour before the value.
+        return map.size() * (sizeof(typename Map::value_type) + 4 * sizeof(void*));
+    }
+
+private:
+    friend class Heap;
+
+    // Heap::Flags, zero for the objects the heap does not manage.
+    std::uint8_t heapFlags = 0;
+};
+
+#endif //LOXPLUS_HEAPOBJECT_H
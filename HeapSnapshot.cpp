@@ -0,0 +1,159 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "HeapSnapshot.h"
+#include "Interpreter.h"
+#include "LoxArray.h"
+#include "LoxFloat64Array.h"
+#include "LoxMap.h"
+#include "LoxStringBuilder.h"
+#include "LoxFile.h"
+#include "LoxGenerator.h"
+#include "LoxFunction.h"
+#include "LoxInstance.h"
+#include "LoxNative.h"
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+    struct Node
+    {
+        HeapSnapshot::Kind kind;
+        std::uint64_t size;
+        std::string label;
+        std::vector<std::uint32_t> edges;
+    };
+
+    // numbers the objects in the order they are reached, recording who references whom.
+    class SnapshotTracer : public Tracer
+    {
+    public:
+        std::vector<Node> nodes;
+        std::vector<HeapObject*> objects;
+        std::vector<std::uint32_t> roots;
+        // node being traced, none while tracing the roots.
+        std::size_t current = SIZE_MAX;
+
+        void visitString(const std::string & string) override
+        {
+            // short strings live inside their owner.
+            if (string.capacity() < sizeof(std::string)) return;
+
+            constexpr std::size_t labelLength = 40;
+            auto label = "\"" + string.substr(0, labelLength) + (string.size() > labelLength ? "...\"" : "\"");
+            edge(add({ HeapSnapshot::Kind::String, string.capacity() + 1, label, {} }, nullptr));
+        }
+
+    protected:
+        void visit(HeapObject*& object) override
+        {
+            auto [it, inserted] = ids.try_emplace(object, nodes.size());
+            if (inserted)
+            {
+                add({ kindOf(object), object->heapSize(), object->describe(), {} }, object);
+            }
+            edge(it->second);
+        }
+
+    private:
+        std::map<HeapObject*, std::uint32_t> ids;
+
+        std::uint32_t add(Node && node, HeapObject* object)
+        {
+            nodes.push_back(std::move(node));
+            objects.push_back(object);
+            return static_cast<std::uint32_t>(nodes.size() - 1);
+        }
+
+        void edge(std::uint32_t target)
+        {
+            if (current == SIZE_MAX) roots.push_back(target);
+            else nodes[current].edges.push_back(target);
+        }
+
+        static HeapSnapshot::Kind kindOf(HeapObject* object)
+        {
+            if (dynamic_cast<Environment*>(object)) return HeapSnapshot::Kind::Environment;
+            if (dynamic_cast<LoxInstance*>(object)) return HeapSnapshot::Kind::Instance;
+            if (dynamic_cast<LoxClass*>(object)) return HeapSnapshot::Kind::Class;
+            if (dynamic_cast<LoxFunction*>(object)) return HeapSnapshot::Kind::Function;
+            if (dynamic_cast<LoxArray*>(object)) return HeapSnapshot::Kind::Array;
+            if (dynamic_cast<LoxFloat64Array*>(object)) return HeapSnapshot::Kind::Float64Array;
+            if (dynamic_cast<LoxMap*>(object)) return HeapSnapshot::Kind::Map;
+            if (dynamic_cast<LoxStringBuilder*>(object)) return HeapSnapshot::Kind::StringBuilder;
+            if (dynamic_cast<LoxFile*>(object)) return HeapSnapshot::Kind::File;
+            if (dynamic_cast<LoxGenerator*>(object)) return HeapSnapshot::Kind::Generator;
+            return HeapSnapshot::Kind::Native;
+        }
+    };
+
+    std::size_t signalSnapshots = 0;
+
+    void onSignal(int)
+    {
+        HeapSnapshot::requested = 1;
+    }
+
+    template <typename T>
+    void put(std::ofstream & file, T value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+}
+
+void HeapSnapshot::installSignalHandler()
+{
+    struct sigaction action {};
+    action.sa_handler = onSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, nullptr);
+}
+
+std::string HeapSnapshot::nextPath()
+{
+    return "loxplus-" + std::to_string(getpid()) + "-" + std::to_string(++signalSnapshots) + ".heapsnapshot";
+}
+
+std::size_t HeapSnapshot::write(Interpreter & interpreter, const std::string & path)
+{
+    SnapshotTracer tracer;
+    interpreter.traceRoots(tracer);
+    for (tracer.current = 0; tracer.current < tracer.nodes.size(); tracer.current++)
+    {
+        if (auto object = tracer.objects[tracer.current]; object != nullptr)
+        {
+            object->trace(tracer);
+        }
+    }
+
+    std::ofstream file { path, std::ios::binary };
+    if (!file) return 0;
+
+    file.write(magic, sizeof(magic));
+    put(file, static_cast<std::uint32_t>(tracer.nodes.size()));
+    for (auto & node : tracer.nodes)
+    {
+        put(file, node.kind);
+        put(file, node.size);
+        put(file, static_cast<std::uint32_t>(node.label.size()));
+        file.write(node.label.data(), node.label.size());
+        put(file, static_cast<std::uint32_t>(node.edges.size()));
+        for (auto edge : node.edges)
+        {
+            put(file, edge);
+        }
+    }
+    put(file, static_cast<std::uint32_t>(tracer.roots.size()));
+    for (auto root : tracer.roots)
+    {
+        put(file, root);
+    }
+
+    return file ? tracer.nodes.size() : 0;
+}
@@ -0,0 +1,59 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_HEAPSNAPSHOT_H
+#define LOXPLUS_HEAPSNAPSHOT_H
+
+#include <csignal>
+#include <cstdint>
+#include <string>
+
+class Interpreter;
+
+/*
+ * Writes every heap object reachable from the interpreter, with its size
+ * and outgoing references, for the heap-analyzer tool. Strings are nodes
+ * of their own when they do not fit in the object holding them.
+ *
+ * Format, in host byte order:
+ *   char[8] magic, u32 node count,
+ *   per node: u8 kind, u64 size, u32 label length, label, u32 edge count, u32 edges[],
+ *   u32 root count, u32 roots[].
+ * */
+class HeapSnapshot
+{
+public:
+    static constexpr char magic[8] = { 'L', 'O', 'X', 'H', 'E', 'A', 'P', '1' };
+
+    enum class Kind : std::uint8_t
+    {
+        Environment,
+        Instance,
+        Class,
+        Function,
+        Native,
+        String,
+        Array,
+        Float64Array,
+        Map,
+        StringBuilder,
+        File,
+        Generator,
+    };
+
+    HeapSnapshot() = delete;
+
+    // set by SIGUSR1, the interpreter writes a snapshot at its next statement.
+    static inline volatile std::sig_atomic_t requested = 0;
+
+    static void installSignalHandler();
+    // "loxplus-<pid>-<n>.heapsnapshot", n counting the snapshots taken by signal.
+    static std::string nextPath();
+
+    // returns the number of nodes written, 0 if the file could not be written.
+    static std::size_t write(Interpreter & interpreter, const std::string & path);
+};
+
+
+#endif //LOXPLUS_HEAPSNAPSHOT_H
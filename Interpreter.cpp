@@ -4,36 +4,95 @@
 
 #include "Interpreter.h"
 #include "Lox-plus.h"
+#include "AllocationProfiler.h"
+#include "ExecutionCounts.h"
+#include "Heap.h"
+#include "HeapSnapshot.h"
+#include "LoxArray.h"
+#include "LoxFloat64Array.h"
+#include "LoxMap.h"
 #include "LoxCallable.h"
 #include "LoxFunction.h"
+#include "LoxGenerator.h"
 #include "LoxInstance.h"
+#include "LoxNative.h"
+#include "NativeError.h"
+#include "Natives.h"
+#include "Output.h"
+#include "Profiler.h"
 #include "Return.h"
 #include <iostream>
+#ifdef __linux__
+#include <pthread.h>
+#endif
 
 using namespace std::string_literals;
 
-Interpreter::Interpreter() = default;
-//{
-    // future STD
-    //globals.define("clock", ...);
-//}
+namespace
+{
+    // the state of an execution, the interpreter's one or a generator's.
+    void traceExecution(Tracer & tracer, std::vector<Object> & stack, Environment*& environment, std::vector<Interpreter::CallFrame> & frames, LoxGenerator*& generator)
+    {
+        for (auto & value : stack)
+        {
+            tracer.trace(value);
+        }
 
-void Interpreter::visitAssignExpr(AssignExpr & expr)
+        tracer.trace(environment);
+
+        for (auto & frame : frames)
+        {
+            tracer.trace(frame.function);
+            tracer.trace(frame.environment);
+        }
+
+        tracer.trace(generator);
+    }
+}
+
+Interpreter::Interpreter()
 {
-    Object value = evaluate(expr.value);
+    Natives::define(*this);
 
-    if (locals.count(&expr))
+#ifdef __linux__
+    // keep enough native stack below the limit to unwind and report the error.
+    constexpr std::size_t safetyMargin = 256 * 1024;
+
+    pthread_attr_t attributes;
+    if (pthread_getattr_np(pthread_self(), &attributes) == 0)
     {
-        auto distance = locals[&expr];
-        environment->assignAt(distance, expr.name, value);
+        void* address;
+        std::size_t size;
+        if (pthread_attr_getstack(&attributes, &address, &size) == 0 && size > 2 * safetyMargin)
+        {
+            nativeStackLimit = static_cast<const char*>(address) + safetyMargin;
+        }
+        pthread_attr_destroy(&attributes);
     }
-    else
+#endif
+}
+
+Interpreter::~Interpreter() = default;
+
+void Interpreter::visitArrayExpr(ArrayExpr & expr)
+{
+    auto base = stack.size();
+    for (auto & element : expr.elements)
     {
-        globals->assign(expr.name, value);
+        if (ExecutionCounts::enabled) countNode(typeid(*element));
+        element->accept(*this);
     }
 
-    environment->assign(expr.name, value);
-    stack.push(value);
+    auto array = LoxArray::create(std::vector<Object>(stack.begin() + base, stack.end()));
+    stack.resize(base);
+    stack.push_back(array);
+}
+
+void Interpreter::visitAssignExpr(AssignExpr & expr)
+{
+    Object value = evaluate(expr.value);
+    assign(expr, value);
+    stack.push_back(std::move(value));
 }
 
 void Interpreter::visitBinaryExpr(BinaryExpr & expr)
@@ -92,14 +151,21 @@ void Interpreter::visitBinaryExpr(BinaryExpr & expr)
     }
     else if (left.isString())
     {
-        std::string l = left.asString();
-        std::string r = right.asString();
+        auto & l = left.asString();
+        auto & r = right.asString();
 
         switch (expr.op.type)
         {
             case TokenType::PLUS:
-                result = l + r;
+            {
+                // a single allocation, moved to the stack. Use a StringBuilder to append in a loop.
+                std::string concatenation;
+                concatenation.reserve(l.size() + r.size());
+                concatenation.append(l).append(r);
+                result = std::move(concatenation);
+                if (AllocationProfiler::enabled) AllocationProfiler::allocated(typeid(std::string), sizeof(std::string) + l.size() + r.size());
                 break;
+            }
             case TokenType::BANG_EQUAL:
                 result = !isEqual(left, right);
                 break;
@@ -125,51 +191,86 @@ void Interpreter::visitBinaryExpr(BinaryExpr & expr)
         }
     }
 
-    stack.push(result);
+    stack.push_back(std::move(result));
 }
 
 void Interpreter::visitCallExpr(CallExpr & expr)
 {
-    Object callee = evaluate(expr.callee);
+    stack.push_back(callValue(expr, nullptr));
+}
 
-    std::vector<Object> arguments;
-    for (auto & argument : expr.arguments)
+void Interpreter::visitGetExpr(GetExpr & expr)
+{
+    Object object = evaluate(expr.object);
+    stack.push_back(getProperty(object, expr.name));
+}
+
+void Interpreter::visitGroupingExpr(GroupingExpr & expr)
+{
+    stack.push_back(evaluate(expr.expression));
+}
+
+void Interpreter::visitIndexExpr(IndexExpr & expr)
+{
+    Object object = evaluate(expr.object);
+    Object index = evaluate(expr.index);
+
+    if (object.isArray())
     {
-        arguments.push_back(evaluate(argument));
+        auto array = object.asArray();
+        stack.push_back(array->get(position(index, array->size(), expr.bracket)));
     }
-
-    if (!callee.isCallable())
+    else if (object.isFloat64Array())
     {
-        throw RuntimeError(expr.paren, "Can only call functions and classes.");
+        auto array = object.asFloat64Array();
+        stack.push_back(array->get(position(index, array->size(), expr.bracket)));
     }
-
-    auto function = callee.asCallable();
-    if (arguments.size() != function->arity())
+    else if (object.isMap())
     {
-        throw RuntimeError(expr.paren, "Expected "s + std::to_string(function->arity()) + " arguments but got "s + std::to_string(arguments.size()) + ".");
+        auto value = object.asMap()->find(mapKey(index, expr.bracket));
+        stack.push_back(value != nullptr ? *value : Object {});
+    }
+    else
+    {
+        throw RuntimeError(expr.bracket, "Only arrays and maps can be indexed.");
     }
-    stack.push(function->call(*this, arguments));
 }
 
-void Interpreter::visitGetExpr(GetExpr & expr)
+void Interpreter::visitIndexSetExpr(IndexSetExpr & expr)
 {
     Object object = evaluate(expr.object);
-    if (!object.isInstance())
+    Object index = evaluate(expr.index);
+    Object value = evaluate(expr.value);
+
+    if (object.isArray())
     {
-        throw RuntimeError(expr.name, "Only instances have properties.");
+        auto array = object.asArray();
+        array->set(position(index, array->size(), expr.bracket), value);
     }
-
-    stack.push(object.asInstance()->get(expr.name));
-}
-
-void Interpreter::visitGroupingExpr(GroupingExpr & expr)
-{
-    stack.push(evaluate(expr.expression));
+    else if (object.isFloat64Array())
+    {
+        auto array = object.asFloat64Array();
+        auto at = position(index, array->size(), expr.bracket);
+        if (!value.isDouble())
+        {
+            throw RuntimeError(expr.bracket, "Float64Array elements must be numbers.");
+        }
+        array->set(at, value.asDouble());
+    }
+    else if (object.isMap())
+    {
+        object.asMap()->set(mapKey(index, expr.bracket), value);
+    }
+    else
+    {
+        throw RuntimeError(expr.bracket, "Only arrays and maps can be indexed.");
+    }
+    stack.push_back(value);
 }
 
 void Interpreter::visitLiteralExpr(LiteralExpr & expr)
 {
-    stack.push(expr.value);
+    stack.push_back(expr.value);
 }
 
 void Interpreter::visitLogicalExpr(LogicalExpr & expr)
@@ -184,11 +285,11 @@ void Interpreter::visitLogicalExpr(LogicalExpr & expr)
      * */
     if ((expr.op.type == TokenType::OR) == isTruthy(left))
     {
-        stack.push(left);
+        stack.push_back(left);
         return;
     }
 
-    stack.push(evaluate(expr.right));
+    stack.push_back(evaluate(expr.right));
 }
 
 void Interpreter::visitSetExpr(SetExpr & expr)
@@ -202,7 +303,7 @@ void Interpreter::visitSetExpr(SetExpr & expr)
 
     Object value = evaluate(expr.value);
     object.asInstance()->set(expr.name, value);
-    stack.push(value);
+    stack.push_back(value);
 }
 
 void Interpreter::visitThisExpr(ThisExpr & expr)
@@ -221,10 +322,10 @@ void Interpreter::visitUnaryExpr(UnaryExpr & expr)
             {
                 throw RuntimeError(expr.op, "Operand must be a number.");
             }
-            stack.push(-1 * right.asDouble());
+            stack.push_back(-1 * right.asDouble());
             break;
         case TokenType::BANG:
-            stack.push(!isTruthy(right));
+            stack.push_back(!isTruthy(right));
             break;
         default:
             throw RuntimeError(expr.op, "Unknown unary operator.");
@@ -236,7 +337,7 @@ void Interpreter::visitVariableExpr(VariableExpr & expr)
     lookUpVariable(expr.name, expr);
 }
 
-bool Interpreter::isTruthy(Object object)
+bool Interpreter::isTruthy(const Object & object)
 {
     bool ret = true;
 
@@ -252,7 +353,7 @@ bool Interpreter::isTruthy(Object object)
     return ret;
 }
 
-bool Interpreter::isEqual(Object left, Object right)
+bool Interpreter::isEqual(const Object & left, const Object & right)
 {
     if (left.index() == right.index())
     {
@@ -272,6 +373,30 @@ bool Interpreter::isEqual(Object left, Object right)
         {
             return left.asBool() == right.asBool();
         }
+        else if (left.isArray())
+        {
+            return left.asArray() == right.asArray();
+        }
+        else if (left.isFloat64Array())
+        {
+            return left.asFloat64Array() == right.asFloat64Array();
+        }
+        else if (left.isMap())
+        {
+            return left.asMap() == right.asMap();
+        }
+        else if (left.isStringBuilder())
+        {
+            return left.asStringBuilder() == right.asStringBuilder();
+        }
+        else if (left.isFile())
+        {
+            return left.asFile() == right.asFile();
+        }
+        else if (left.isGenerator())
+        {
+            return left.asGenerator() == right.asGenerator();
+        }
     }
 
     return false;
@@ -279,9 +404,10 @@ bool Interpreter::isEqual(Object left, Object right)
 
 Object Interpreter::evaluate(Expr* expr)
 {
+    if (ExecutionCounts::enabled) countNode(typeid(*expr));
     expr->accept(*this);
-    auto s = stack.top();
-    stack.pop();
+    auto s = std::move(stack.back());
+    stack.pop_back();
     return s;
 }
 
@@ -296,6 +422,8 @@ void Interpreter::interpret(const std::vector<Stmt*> & statements)
     }
     catch (const RuntimeError & error)
     {
+        frames.clear();
+        stack.clear();
         LoxPlus::runtimeError(error);
     }
 }
@@ -312,22 +440,64 @@ void Interpreter::visitClassStmt(ClassStmt & stmt)
     std::map<std::string, LoxFunction*> methods;
     for (auto & method : stmt.methods)
     {
-        auto function = LoxFunction::create(method, environment, method->name.lexeme == "init");
+        auto function = LoxFunction::create(method, environment, method->name.lexeme == "init", generators.count(method) != 0);
         methods.emplace(method->name.lexeme, function);
     }
 
-    auto klass = LoxClass::create(stmt.name.lexeme, std::move(methods));
+    auto klass = LoxClass::create(stmt.name.lexeme, &stmt, std::move(methods));
     environment->assign(stmt.name, klass);
 }
 
 void Interpreter::visitExpressionStmt(ExpressionStmt & stmt)
 {
+    // the value of an assignment statement is discarded, move it into the variable.
+    if (auto* assignment = dynamic_cast<AssignExpr*>(stmt.expression); assignment != nullptr)
+    {
+        if (ExecutionCounts::enabled) countNode(typeid(*assignment));
+        assign(*assignment, evaluate(assignment->value));
+        return;
+    }
+
     evaluate(stmt.expression);
 }
 
+void Interpreter::visitForStmt(ForStmt & stmt)
+{
+    // the loop variable lives in a single environment for the whole loop.
+    auto previous = environment;
+    environment = Environment::create(previous);
+
+    try
+    {
+        if (stmt.initializer != nullptr)
+        {
+            execute(stmt.initializer);
+        }
+
+        auto it = loops.find(&stmt);
+        auto info = it != loops.end() ? it->second : LoopInfo {};
+
+        // the fast path never evaluates the condition and the increment, they would not be counted.
+        if (info.counted && !ExecutionCounts::enabled)
+        {
+            executeCountedLoop(stmt, info);
+        }
+        else
+        {
+            executeLoop(stmt, info);
+        }
+    }
+    catch(...)
+    {
+        environment = previous;
+        throw;
+    }
+    environment = previous;
+}
+
 void Interpreter::visitFunctionStmt(FunctionStmt & stmt)
 {
-    auto function = LoxFunction::create(&stmt, environment, false);
+    auto function = LoxFunction::create(&stmt, environment, false, generators.count(&stmt) != 0);
     environment->define(stmt.name.lexeme, function);
 }
 
@@ -346,15 +516,30 @@ void Interpreter::visitIfStmt(IfStmt & stmt)
 void Interpreter::visitPrintStmt(PrintStmt & stmt)
 {
     Object value = evaluate(stmt.expression);
-    std::cout << to_string(value) << '\n';
+    if (value.isString())
+    {
+        Output::line(value.asString());
+    }
+    else
+    {
+        Output::line(to_string(value));
+    }
 }
 
 void Interpreter::visitReturnStmt(ReturnStmt & stmt)
 {
-    Object value = nullptr;
-    if (stmt.value != nullptr) value = evaluate(stmt.value);
+    Return result { nullptr };
+    if (tailCalls.count(&stmt))
+    {
+        // the pending call, if any, unwinds to the enclosing LoxFunction::call which runs it in place.
+        result.value = callValue(*static_cast<CallExpr*>(stmt.value), &result);
+    }
+    else if (stmt.value != nullptr)
+    {
+        result.value = evaluate(stmt.value);
+    }
 
-    throw Return(value);
+    throw std::move(result);
 }
 
 void Interpreter::visitVarStmt(VarStmt & stmt)
@@ -376,11 +561,47 @@ void Interpreter::visitWhileStmt(WhileStmt & stmt)
     }
 }
 
+void Interpreter::visitYieldStmt(YieldStmt & stmt)
+{
+    Object value;
+    if (stmt.value != nullptr)
+    {
+        value = evaluate(stmt.value);
+    }
+
+    LoxGenerator::yield(*this, std::move(value));
+}
+
 void Interpreter::execute(Stmt* stmt)
 {
+    enterStatement(stmt);
     stmt->accept(*this);
 }
 
+void Interpreter::enterStatement(Stmt* stmt)
+{
+    currentLine = stmt->line;
+    if (ExecutionCounts::enabled) countNode(typeid(*stmt));
+    if (Profiler::pending)
+    {
+        Profiler::record(frames, currentLine);
+    }
+    if (HeapSnapshot::requested)
+    {
+        HeapSnapshot::requested = 0;
+        auto path = HeapSnapshot::nextPath();
+        if (HeapSnapshot::write(*this, path) == 0)
+        {
+            Output::flush();
+            std::cerr << "Cannot write heap snapshot to '" << path << "'.\n";
+        }
+    }
+    if (Heap::collectionPending)
+    {
+        Heap::collect();
+    }
+}
+
 void Interpreter::executeBlock(const std::vector<Stmt*> & statements, Environment* environment)
 {
     auto previous = this->environment;
@@ -402,20 +623,520 @@ void Interpreter::executeBlock(const std::vector<Stmt*> & statements, Environmen
     this->environment = previous;
 }
 
+bool Interpreter::executeBody(const std::vector<Stmt*> & statements, Environment* environment, Return & result)
+{
+    auto previous = this->environment;
+    auto returned = false;
+
+    try
+    {
+        this->environment = environment;
+
+        for (std::size_t i = 0; i + 1 < statements.size(); i++)
+        {
+            execute(statements[i]);
+        }
+        if (!statements.empty())
+        {
+            returned = executeTail(statements.back(), result);
+        }
+    }
+    catch(...)
+    {
+        this->environment = previous;
+        throw;
+    }
+    this->environment = previous;
+
+    return returned;
+}
+
+bool Interpreter::executeTail(Stmt* stmt, Return & result)
+{
+    if (auto returnStmt = dynamic_cast<ReturnStmt*>(stmt))
+    {
+        enterStatement(stmt);
+        if (tailCalls.count(returnStmt))
+        {
+            result.value = callValue(*static_cast<CallExpr*>(returnStmt->value), &result);
+        }
+        else if (returnStmt->value != nullptr)
+        {
+            result.value = evaluate(returnStmt->value);
+        }
+        return true;
+    }
+
+    if (auto ifStmt = dynamic_cast<IfStmt*>(stmt))
+    {
+        enterStatement(stmt);
+        if (isTruthy(evaluate(ifStmt->condition)))
+        {
+            return executeTail(ifStmt->thenBranch, result);
+        }
+        return ifStmt->elseBranch != nullptr && executeTail(ifStmt->elseBranch, result);
+    }
+
+    if (auto block = dynamic_cast<BlockStmt*>(stmt))
+    {
+        enterStatement(stmt);
+        return executeBody(block->statements, Environment::create(environment), result);
+    }
+
+    execute(stmt);
+    return false;
+}
+
+void Interpreter::executeLoop(ForStmt & stmt, const LoopInfo & info)
+{
+    BlockStmt* block = nullptr;
+    Environment* bodyEnvironment = nullptr;
+    if (info.reuseBodyEnvironment)
+    {
+        block = dynamic_cast<BlockStmt*>(stmt.body);
+        if (block != nullptr) bodyEnvironment = Environment::create(environment);
+    }
+
+    while (stmt.condition == nullptr || isTruthy(evaluate(stmt.condition)))
+    {
+        executeLoopBody(stmt, block, bodyEnvironment);
+
+        if (stmt.increment != nullptr)
+        {
+            evaluate(stmt.increment);
+        }
+    }
+}
+
+void Interpreter::executeCountedLoop(ForStmt & stmt, const LoopInfo & info)
+{
+    BlockStmt* block = nullptr;
+    Environment* bodyEnvironment = nullptr;
+    if (info.reuseBodyEnvironment)
+    {
+        block = dynamic_cast<BlockStmt*>(stmt.body);
+        if (block != nullptr) bodyEnvironment = Environment::create(environment);
+    }
+
+    auto* literal = dynamic_cast<LiteralExpr*>(info.limit);
+    auto* counter = environment->slot(info.variable);
+
+    // the induction variable is updated in place, any non-number value
+    // hands the remaining iterations over to the generic path.
+    while (counter->isDouble())
+    {
+        Object limit = literal != nullptr ? literal->value : evaluate(info.limit);
+        if (!limit.isDouble()) break;
+
+        double i = counter->asDouble();
+        double l = limit.asDouble();
+        bool keepGoing;
+        switch (info.comparison)
+        {
+            case TokenType::LESS:
+                keepGoing = i < l;
+                break;
+            case TokenType::LESS_EQUAL:
+                keepGoing = i <= l;
+                break;
+            case TokenType::GREATER:
+                keepGoing = i > l;
+                break;
+            default:
+                keepGoing = i >= l;
+                break;
+        }
+        if (!keepGoing) return;
+
+        executeLoopBody(stmt, block, bodyEnvironment);
+
+        if (!counter->isDouble())
+        {
+            evaluate(stmt.increment);
+            break;
+        }
+        Heap::Mutation mutation { environment };
+        mutation.store(*counter, counter->asDouble() + info.step);
+    }
+
+    executeLoop(stmt, info);
+}
+
+void Interpreter::executeLoopBody(ForStmt & stmt, BlockStmt* block, Environment* bodyEnvironment)
+{
+    if (bodyEnvironment != nullptr)
+    {
+        executeBlock(block->statements, bodyEnvironment);
+    }
+    else
+    {
+        execute(stmt.body);
+    }
+}
+
 void Interpreter::resolve(Expr & expr, unsigned long depth)
 {
     locals[&expr] = depth;
 }
 
+void Interpreter::resolve(ForStmt & stmt, LoopInfo info)
+{
+    loops[&stmt] = std::move(info);
+}
+
+void Interpreter::resolveTailCall(ReturnStmt & stmt)
+{
+    tailCalls.insert(&stmt);
+}
+
+void Interpreter::resolveStackAllocation(CallExpr & expr, ClassStmt* klass)
+{
+    stackAllocations[&expr] = klass;
+}
+
+void Interpreter::resolveInlineBody(FunctionStmt & stmt, InlineBody body)
+{
+    inlineBodies[&stmt] = body;
+}
+
+void Interpreter::resolveGenerator(FunctionStmt & stmt)
+{
+    generators.insert(&stmt);
+}
+
+void Interpreter::swapContext(Context & context)
+{
+    std::swap(stack, context.stack);
+    std::swap(environment, context.environment);
+    std::swap(frames, context.frames);
+    std::swap(currentLine, context.line);
+    std::swap(nativeStackLimit, context.nativeStackLimit);
+    std::swap(generator, context.generator);
+}
+
+LoxInstance* Interpreter::frameInstance(CallExpr & expr, LoxClass* klass)
+{
+    auto depth = frames.size() - 1;
+    if (depth >= frameInstances.size())
+    {
+        frameInstances.resize(depth + 1);
+    }
+
+    // the previous instance of this site in this frame is dead, recycle it.
+    for (auto & [site, instance] : frameInstances[depth])
+    {
+        if (site == &expr)
+        {
+            Heap::Mutation mutation { instance.get() };
+            mutation.discardFields();
+            *instance = LoxInstance { klass };
+            return instance.get();
+        }
+    }
+
+    frameInstances[depth].emplace_back(&expr, std::make_unique<LoxInstance>(klass));
+    return frameInstances[depth].back().second.get();
+}
+
+Object Interpreter::callValue(CallExpr & expr, Return* tail)
+{
+    auto & site = callSites[&expr];
+    if (!site.classified)
+    {
+        site.method = dynamic_cast<GetExpr*>(expr.callee);
+        site.classified = true;
+    }
+
+    // methods are looked up without being bound, an inlined call never allocates the bound function.
+    Object callee;
+    LoxInstance* receiver = nullptr;
+    LoxFunction* method = nullptr;
+    if (site.method != nullptr)
+    {
+        Object object = evaluate(site.method->object);
+        if (object.isInstance() && !object.asInstance()->hasField(site.method->name.lexeme))
+        {
+            receiver = object.asInstance();
+            method = receiver->getClass()->getMethod(site.method->name.lexeme);
+        }
+
+        if (method == nullptr)
+        {
+            callee = getProperty(object, site.method->name);
+        }
+    }
+    else
+    {
+        callee = evaluate(expr.callee);
+    }
+
+    // arguments stay on the value stack, callees see them through a view.
+    auto base = stack.size();
+    for (auto & argument : expr.arguments)
+    {
+        if (ExecutionCounts::enabled) countNode(typeid(*argument));
+        argument->accept(*this);
+    }
+    Arguments arguments { stack.data() + base, expr.arguments.size() };
+
+    LoxCallable* function = method;
+    if (method == nullptr)
+    {
+        if (!callee.isCallable())
+        {
+            throw RuntimeError(expr.paren, "Can only call functions and classes.");
+        }
+        function = callee.asCallable();
+    }
+
+    if (arguments.size() != function->arity())
+    {
+        throw RuntimeError(expr.paren, "Expected "s + std::to_string(function->arity()) + " arguments but got "s + std::to_string(arguments.size()) + ".");
+    }
+
+    if (stackExhausted())
+    {
+        throw RuntimeError(expr.paren, "Stack overflow.");
+    }
+
+    Object result;
+    auto target = method != nullptr ? method : callee.isFunction() ? callee.asFunction() : nullptr;
+    if (target != nullptr && observe(site, target, receiver != nullptr ? receiver->getClass() : nullptr))
+    {
+        result = callInline(site, target, receiver, arguments);
+    }
+    else
+    {
+        if (method != nullptr)
+        {
+            callee = method->bind(receiver);
+        }
+
+        // handed back to the enclosing LoxFunction::call which runs the callee in place.
+        if (tail != nullptr && callee.isFunction())
+        {
+            *tail = Return { callee.asFunction(), arguments };
+            stack.resize(base);
+            return Object();
+        }
+
+        // a generator's frames would take the instances with them when it is collected, at any time.
+        auto klass = callee.isClass() && !frames.empty() && generator == nullptr ? callee.asClass() : nullptr;
+        auto allocation = klass != nullptr ? stackAllocations.find(&expr) : stackAllocations.end();
+        if (allocation != stackAllocations.end() && allocation->second == klass->getDeclaration())
+        {
+            result = klass->construct(*this, arguments, frameInstance(expr, klass));
+        }
+        else if (callee.isNative())
+        {
+            try
+            {
+                result = callee.asNative()->call(*this, arguments);
+            }
+            catch (const NativeError & error)
+            {
+                throw RuntimeError(expr.paren, error.what());
+            }
+        }
+        else
+        {
+            result = callee.asCallable()->call(*this, arguments);
+        }
+    }
+
+    stack.resize(base);
+    return result;
+}
+
+Object Interpreter::getProperty(const Object & object, const Token & name)
+{
+    if (!object.isInstance())
+    {
+        throw RuntimeError(name, "Only instances have properties.");
+    }
+
+    return object.asInstance()->get(name);
+}
+
+std::size_t Interpreter::position(const Object & index, std::size_t size, const Token & bracket)
+{
+    if (!index.isDouble())
+    {
+        throw RuntimeError(bracket, "Array index must be a number.");
+    }
+
+    auto value = index.asDouble();
+    // also false for NaN.
+    if (!(value >= 0 && value < size))
+    {
+        throw RuntimeError(bracket, "Array index out of range.");
+    }
+
+    auto position = static_cast<std::size_t>(value);
+    if (position != value)
+    {
+        throw RuntimeError(bracket, "Array index must be an integer.");
+    }
+
+    return position;
+}
+
+const Object & Interpreter::mapKey(const Object & key, const Token & bracket)
+{
+    if (!LoxMap::isValidKey(key))
+    {
+        throw RuntimeError(bracket, "Map keys must be strings, numbers or booleans.");
+    }
+
+    return key;
+}
+
+bool Interpreter::observe(CallSite & site, LoxFunction* function, LoxClass* receiver)
+{
+    if (site.polymorphic) return false;
+
+    if (site.function == nullptr)
+    {
+        site.function = function;
+        site.receiver = receiver;
+
+        auto it = inlineBodies.find(function->getDeclaration());
+        site.body = it != inlineBodies.end() ? &it->second : nullptr;
+    }
+    else if (site.function != function || site.receiver != receiver)
+    {
+        site.polymorphic = true;
+        return false;
+    }
+
+    // inline once the same callee has been seen twice in a row.
+    if (site.hits < 2) site.hits++;
+    return site.body != nullptr && site.hits == 2 && !site.active;
+}
+
+Object Interpreter::callInline(CallSite & site, LoxFunction* function, LoxInstance* receiver, Arguments arguments)
+{
+    // the guards in observe() make the callee's closure the same on every inlined call.
+    if (site.environment == nullptr)
+    {
+        auto enclosing = function->getClosure();
+        if (receiver != nullptr)
+        {
+            site.thisEnvironment = Environment::create(enclosing);
+            enclosing = site.thisEnvironment;
+        }
+        site.environment = Environment::create(enclosing);
+    }
+
+    if (receiver != nullptr)
+    {
+        site.thisEnvironment->define("this", receiver);
+    }
+
+    int i = 0;
+    for (auto & parameter : function->getDeclaration()->parameters)
+    {
+        site.environment->define(parameter.lexeme, arguments[i++]);
+    }
+
+    auto previous = environment;
+    environment = site.environment;
+    site.active = true;
+
+    Object result;
+    try
+    {
+        result = evaluate(site.body->expression);
+    }
+    catch(...)
+    {
+        environment = previous;
+        site.active = false;
+        throw;
+    }
+    environment = previous;
+    site.active = false;
+
+    if (site.body->returnsValue) return result;
+    return Object();
+}
+
+bool Interpreter::stackExhausted() const
+{
+    if (frames.size() >= maxCallDepth) return true;
+
+    char marker;
+    return nativeStackLimit != nullptr && &marker < nativeStackLimit;
+}
+
+void Interpreter::countNode(const std::type_info & kind)
+{
+    ExecutionCounts::count(kind, currentLine, frames.empty() ? nullptr : frames.back().function->getDeclaration());
+}
+
+void Interpreter::traceRoots(Tracer & tracer)
+{
+    // the generator running holds the state of the execution that resumed it.
+    traceExecution(tracer, stack, environment, frames, generator);
+    tracer.trace(globals);
+
+    for (auto & [expr, site] : callSites)
+    {
+        tracer.trace(site.function);
+        tracer.trace(site.receiver);
+        tracer.trace(site.thisEnvironment);
+        tracer.trace(site.environment);
+    }
+
+    // owned by their frame, but visited like any other instance.
+    for (auto & slots : frameInstances)
+    {
+        for (auto & [allocation, instance] : slots)
+        {
+            auto object = instance.get();
+            tracer.trace(object);
+        }
+    }
+}
+
+void Interpreter::setMaxCallDepth(std::size_t depth)
+{
+    maxCallDepth = depth;
+}
+
+void Interpreter::defineNative(std::string name, int arity, NativeFunction function)
+{
+    auto native = LoxNative::create(name, arity, function);
+    globals->define(std::move(name), native);
+}
+
+void Interpreter::assign(AssignExpr & expr, Object value)
+{
+    if (locals.count(&expr))
+    {
+        auto distance = locals[&expr];
+        environment->assignAt(distance, expr.name, std::move(value));
+    }
+    else
+    {
+        globals->assign(expr.name, std::move(value));
+    }
+}
+
 void Interpreter::lookUpVariable(Token name, Expr & expr)
 {
     if (locals.count(&expr))
     {
         auto distance = locals[&expr];
-        stack.push(environment->getAt(distance, name.lexeme));
+        stack.push_back(environment->getAt(distance, name.lexeme));
     }
     else
     {
-        stack.push(globals->get(name));
+        stack.push_back(globals->get(name));
     }
 }
+
+void Interpreter::Context::trace(Tracer & tracer)
+{
+    traceExecution(tracer, stack, environment, frames, generator);
+}
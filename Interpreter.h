@@ -5,26 +5,80 @@
 #ifndef LOXPLUS_INTERPRETER_H
 #define LOXPLUS_INTERPRETER_H
 
-#include <stack>
 #include <vector>
 #include <map>
+#include <set>
+#include <typeinfo>
 #include "ast.h"
+#include "Arguments.h"
 #include "Environment.h"
 
+class LoxClass;
+class LoxFunction;
+class LoxGenerator;
+class LoxInstance;
+class Return;
+
 class Interpreter : public VisitorExpr, public VisitorStmt
 {
 public:
+    using NativeFunction = Object (*)(Interpreter & interpreter, Arguments arguments);
+
+    struct CallFrame
+    {
+        LoxFunction* function;
+        Environment* environment;
+        // line of the caller when the call was made.
+        std::size_t line;
+    };
+
+    struct LoopInfo
+    {
+        bool reuseBodyEnvironment = false;
+
+        // counted loop: "for (var variable = ...; variable <comparison> limit; variable = variable + step)"
+        bool counted = false;
+        std::string variable;
+        TokenType comparison = TokenType::LESS;
+        Expr* limit = nullptr;
+        double step = 0;
+    };
+
+    // body of a function made of a single "return expression;" or "expression;".
+    struct InlineBody
+    {
+        Expr* expression;
+        bool returnsValue;
+    };
+
+    // what a generator runs with, swapped with the interpreter's own when it is resumed.
+    struct Context
+    {
+        std::vector<Object> stack;
+        Environment* environment = nullptr;
+        std::vector<CallFrame> frames;
+        std::size_t line = 0;
+        const char* nativeStackLimit = nullptr;
+        LoxGenerator* generator = nullptr;
+
+        void trace(Tracer & tracer);
+    };
+
     Interpreter();
     Interpreter(const Interpreter&) = delete;
     Interpreter(Interpreter&&) = default;
     Interpreter& operator=(const Interpreter&) = delete;
     Interpreter& operator=(Interpreter&&) = default;
+    ~Interpreter() override;
 
+    void visitArrayExpr(ArrayExpr & expr) override;
     void visitAssignExpr(AssignExpr & expr) override;
     void visitBinaryExpr(BinaryExpr & expr) override;
     void visitCallExpr(CallExpr & expr) override;
     void visitGetExpr(GetExpr & expr) override;
     void visitGroupingExpr(GroupingExpr & expr) override;
+    void visitIndexExpr(IndexExpr & expr) override;
+    void visitIndexSetExpr(IndexSetExpr & expr) override;
     void visitLiteralExpr(LiteralExpr & expr) override;
     void visitLogicalExpr(LogicalExpr & expr) override;
     void visitSetExpr(SetExpr & expr) override;
@@ -36,33 +90,119 @@ public:
     void visitBlockStmt(BlockStmt & stmt) override;
     void visitClassStmt(ClassStmt & stmt) override;
     void visitExpressionStmt(ExpressionStmt & stmt) override;
+    void visitForStmt(ForStmt & stmt) override;
     void visitFunctionStmt(FunctionStmt & stmt) override;
     void visitIfStmt(IfStmt & stmt) override;
     void visitPrintStmt(PrintStmt & stmt) override;
     void visitReturnStmt(ReturnStmt & stmt) override;
     void visitVarStmt(VarStmt & stmt) override;
+    void visitYieldStmt(YieldStmt & stmt) override;
 
     void interpret(const std::vector<Stmt*> & statements);
 
+    void setMaxCallDepth(std::size_t depth);
+
+    // lets 'tracer' visit, and update, every heap object the interpreter references directly.
+    void traceRoots(Tracer & tracer);
+
+    const std::vector<CallFrame> & callStack() const { return frames; }
+    std::size_t line() const { return currentLine; }
+    // makes a C++ function callable from Lox as the global 'name'.
+    void defineNative(std::string name, int arity, NativeFunction function);
+
     void resolve(Expr & expr, unsigned long depth);
+    void resolve(ForStmt & stmt, LoopInfo info);
+    void resolveTailCall(ReturnStmt & stmt);
+    void resolveStackAllocation(CallExpr & expr, ClassStmt* klass);
+    void resolveInlineBody(FunctionStmt & stmt, InlineBody body);
+    void resolveGenerator(FunctionStmt & stmt);
+
+    // trades the state of the execution with 'context'.
+    void swapContext(Context & context);
 
 private:
-    std::stack<Object> stack;
+    struct CallSite
+    {
+        GetExpr* method = nullptr;
+        bool classified = false;
+
+        // first callee seen, any other one makes the site polymorphic for good.
+        LoxFunction* function = nullptr;
+        LoxClass* receiver = nullptr;
+        const InlineBody* body = nullptr;
+        unsigned int hits = 0;
+        bool polymorphic = false;
+
+        // environments reused by the inlined body, guarded against re-entrance.
+        Environment* thisEnvironment = nullptr;
+        Environment* environment = nullptr;
+        bool active = false;
+    };
+
+    // values being computed, call arguments are handed to callees in place.
+    std::vector<Object> stack;
     Environment* globals = Environment::create();
     Environment* environment = globals;
     std::map<Expr*, unsigned long> locals;
+    std::map<ForStmt*, LoopInfo> loops;
+    std::set<ReturnStmt*> tailCalls;
+
+    // Lox call frames, kept apart from the native stack.
+    std::vector<CallFrame> frames;
+    // line of the statement being executed.
+    std::size_t currentLine = 0;
+    std::size_t maxCallDepth = 10000;
+    // lowest native stack address calls may reach before reporting an overflow.
+    const char* nativeStackLimit = nullptr;
+
+    // functions whose body yields, and the generator running, if any.
+    std::set<FunctionStmt*> generators;
+    LoxGenerator* generator = nullptr;
+
+    // instances that never outlive their call, one reusable slot per (frame depth, allocation site).
+    std::map<CallExpr*, ClassStmt*> stackAllocations;
+    std::vector<std::vector<std::pair<CallExpr*, std::unique_ptr<LoxInstance>>>> frameInstances;
+
+    // functions small enough to be evaluated in place of a call, and what each call site observed.
+    std::map<FunctionStmt*, InlineBody> inlineBodies;
+    std::map<CallExpr*, CallSite> callSites;
 
     Object evaluate(Expr* expr);
 
-    bool isTruthy(Object object);
-    bool isEqual(Object left, Object right);
+    bool isTruthy(const Object & object);
+    bool isEqual(const Object & left, const Object & right);
 
     void execute(Stmt* stmt);
+    // what precedes each statement: its line, the profilers and the collector's safepoint.
+    void enterStatement(Stmt* stmt);
     void executeBlock(const std::vector<Stmt*> & statements, Environment* environment);
+    // runs a function's body, true when the statements ending it returned 'result' without throwing.
+    // a call in tail position is left in 'result' instead of being made.
+    bool executeBody(const std::vector<Stmt*> & statements, Environment* environment, Return & result);
+    bool executeTail(Stmt* stmt, Return & result);
+    void executeLoop(ForStmt & stmt, const LoopInfo & info);
+    void executeCountedLoop(ForStmt & stmt, const LoopInfo & info);
+    void executeLoopBody(ForStmt & stmt, BlockStmt* block, Environment* bodyEnvironment);
 
     friend class LoxFunction;
+    friend class LoxGenerator;
 
     void lookUpVariable(Token name, Expr & expr);
+    // stores 'value' in the variable 'expr' assigns.
+    void assign(AssignExpr & expr, Object value);
+
+    // with 'tail', a call to a LoxFunction is stored in it instead of being made.
+    Object callValue(CallExpr & expr, Return* tail);
+    Object getProperty(const Object & object, const Token & name);
+    // element position given by 'index', checked against the size of the array.
+    std::size_t position(const Object & index, std::size_t size, const Token & bracket);
+    // 'key' once checked it can index a map.
+    const Object & mapKey(const Object & key, const Token & bracket);
+    bool observe(CallSite & site, LoxFunction* function, LoxClass* receiver);
+    Object callInline(CallSite & site, LoxFunction* function, LoxInstance* receiver, Arguments arguments);
+    bool stackExhausted() const;
+    void countNode(const std::type_info & kind);
+    LoxInstance* frameInstance(CallExpr & expr, LoxClass* klass);
 };
 
 #endif //LOXPLUS_INTERPRETER_H
@@ -0,0 +1,294 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Kernels.h"
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LOXPLUS_AVX2 1
+#define LOXPLUS_AVX2_TARGET __attribute__((target("avx2,fma")))
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    enum class Operation { Add, Subtract, Multiply, Divide };
+
+    bool detectAvx2()
+    {
+#ifdef LOXPLUS_AVX2
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+    }
+
+    const bool hasAvx2 = detectAvx2();
+    bool simdEnabled = true;
+
+    bool vectorised()
+    {
+        return simdEnabled && hasAvx2;
+    }
+
+    template <Operation operation>
+    double apply(double x, double y)
+    {
+        switch (operation)
+        {
+            case Operation::Add: return x + y;
+            case Operation::Subtract: return x - y;
+            case Operation::Multiply: return x * y;
+            case Operation::Divide: return x / y;
+        }
+        return 0;
+    }
+
+    template <Operation operation>
+    void elementwiseScalar(double* out, const double* x, const double* y, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            out[i] = apply<operation>(x[i], y[i]);
+        }
+    }
+
+#ifdef LOXPLUS_AVX2
+    LOXPLUS_AVX2_TARGET double horizontalSum(__m256d value)
+    {
+        auto low = _mm_add_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+    }
+
+    // the reductions keep four accumulators to hide the latency of the additions.
+    LOXPLUS_AVX2_TARGET double sumAvx2(const double* x, std::size_t count)
+    {
+        auto a0 = _mm256_setzero_pd(), a1 = a0, a2 = a0, a3 = a0;
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+            a1 = _mm256_add_pd(a1, _mm256_loadu_pd(x + i + 4));
+            a2 = _mm256_add_pd(a2, _mm256_loadu_pd(x + i + 8));
+            a3 = _mm256_add_pd(a3, _mm256_loadu_pd(x + i + 12));
+        }
+        for (; i + 4 <= count; i += 4)
+        {
+            a0 = _mm256_add_pd(a0, _mm256_loadu_pd(x + i));
+        }
+
+        auto total = horizontalSum(_mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3)));
+        for (; i < count; i++)
+        {
+            total += x[i];
+        }
+        return total;
+    }
+
+    LOXPLUS_AVX2_TARGET double dotAvx2(const double* x, const double* y, std::size_t count)
+    {
+        auto a0 = _mm256_setzero_pd(), a1 = a0, a2 = a0, a3 = a0;
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            a0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), a0);
+            a1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), a1);
+            a2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8), a2);
+            a3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), a3);
+        }
+        for (; i + 4 <= count; i += 4)
+        {
+            a0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), a0);
+        }
+
+        auto total = horizontalSum(_mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3)));
+        for (; i < count; i++)
+        {
+            total += x[i] * y[i];
+        }
+        return total;
+    }
+
+    template <bool minimum>
+    LOXPLUS_AVX2_TARGET double extremumAvx2(const double* x, std::size_t count)
+    {
+        auto a0 = _mm256_set1_pd(x[0]), a1 = a0;
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            a0 = minimum ? _mm256_min_pd(a0, _mm256_loadu_pd(x + i)) : _mm256_max_pd(a0, _mm256_loadu_pd(x + i));
+            a1 = minimum ? _mm256_min_pd(a1, _mm256_loadu_pd(x + i + 4)) : _mm256_max_pd(a1, _mm256_loadu_pd(x + i + 4));
+        }
+
+        double lanes[4];
+        _mm256_storeu_pd(lanes, minimum ? _mm256_min_pd(a0, a1) : _mm256_max_pd(a0, a1));
+        auto result = lanes[0];
+        for (auto lane : { lanes[1], lanes[2], lanes[3] })
+        {
+            result = minimum ? std::min(result, lane) : std::max(result, lane);
+        }
+        for (; i < count; i++)
+        {
+            result = minimum ? std::min(result, x[i]) : std::max(result, x[i]);
+        }
+        return result;
+    }
+
+    LOXPLUS_AVX2_TARGET void scaleAvx2(double* x, double factor, std::size_t count)
+    {
+        auto scale = _mm256_set1_pd(factor);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_pd(x + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), scale));
+        }
+        for (; i < count; i++)
+        {
+            x[i] *= factor;
+        }
+    }
+
+    LOXPLUS_AVX2_TARGET void axpyAvx2(double alpha, const double* x, double* y, std::size_t count)
+    {
+        auto a = _mm256_set1_pd(alpha);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_pd(y + i, _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        }
+        for (; i < count; i++)
+        {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    template <Operation operation>
+    LOXPLUS_AVX2_TARGET __m256d apply(__m256d x, __m256d y)
+    {
+        switch (operation)
+        {
+            case Operation::Add: return _mm256_add_pd(x, y);
+            case Operation::Subtract: return _mm256_sub_pd(x, y);
+            case Operation::Multiply: return _mm256_mul_pd(x, y);
+            case Operation::Divide: return _mm256_div_pd(x, y);
+        }
+        return x;
+    }
+
+    template <Operation operation>
+    LOXPLUS_AVX2_TARGET void elementwiseAvx2(double* out, const double* x, const double* y, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_pd(out + i, apply<operation>(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        }
+        elementwiseScalar<operation>(out + i, x + i, y + i, count - i);
+    }
+#endif
+
+    template <Operation operation>
+    void elementwise(double* out, const double* x, const double* y, std::size_t count)
+    {
+#ifdef LOXPLUS_AVX2
+        if (vectorised()) return elementwiseAvx2<operation>(out, x, y, count);
+#endif
+        elementwiseScalar<operation>(out, x, y, count);
+    }
+}
+
+void Kernels::setSimd(bool enabled)
+{
+    simdEnabled = enabled;
+}
+
+bool Kernels::simd()
+{
+    return vectorised();
+}
+
+double Kernels::sum(const double* x, std::size_t count)
+{
+#ifdef LOXPLUS_AVX2
+    if (vectorised()) return sumAvx2(x, count);
+#endif
+    double total = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        total += x[i];
+    }
+    return total;
+}
+
+double Kernels::dot(const double* x, const double* y, std::size_t count)
+{
+#ifdef LOXPLUS_AVX2
+    if (vectorised()) return dotAvx2(x, y, count);
+#endif
+    double total = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        total += x[i] * y[i];
+    }
+    return total;
+}
+
+double Kernels::min(const double* x, std::size_t count)
+{
+#ifdef LOXPLUS_AVX2
+    if (vectorised()) return extremumAvx2<true>(x, count);
+#endif
+    return *std::min_element(x, x + count);
+}
+
+double Kernels::max(const double* x, std::size_t count)
+{
+#ifdef LOXPLUS_AVX2
+    if (vectorised()) return extremumAvx2<false>(x, count);
+#endif
+    return *std::max_element(x, x + count);
+}
+
+void Kernels::scale(double* x, double factor, std::size_t count)
+{
+#ifdef LOXPLUS_AVX2
+    if (vectorised()) return scaleAvx2(x, factor, count);
+#endif
+    for (std::size_t i = 0; i < count; i++)
+    {
+        x[i] *= factor;
+    }
+}
+
+void Kernels::axpy(double alpha, const double* x, double* y, std::size_t count)
+{
+#ifdef LOXPLUS_AVX2
+    if (vectorised()) return axpyAvx2(alpha, x, y, count);
+#endif
+    for (std::size_t i = 0; i < count; i++)
+    {
+        y[i] += alpha * x[i];
+    }
+}
+
+void Kernels::add(double* out, const double* x, const double* y, std::size_t count)
+{
+    elementwise<Operation::Add>(out, x, y, count);
+}
+
+void Kernels::subtract(double* out, const double* x, const double* y, std::size_t count)
+{
+    elementwise<Operation::Subtract>(out, x, y, count);
+}
+
+void Kernels::multiply(double* out, const double* x, const double* y, std::size_t count)
+{
+    elementwise<Operation::Multiply>(out, x, y, count);
+}
+
+void Kernels::divide(double* out, const double* x, const double* y, std::size_t count)
+{
+    elementwise<Operation::Divide>(out, x, y, count);
+}
@@ -0,0 +1,43 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_KERNELS_H
+#define LOXPLUS_KERNELS_H
+
+#include <cstddef>
+
+/*
+ * Loops over raw doubles behind the Float64Array natives. They use AVX2
+ * and FMA when the processor has them, scalar code otherwise. The vector
+ * reductions add in a different order than the scalar ones, their
+ * results may differ in the last bits.
+ * */
+class Kernels
+{
+public:
+    Kernels() = delete;
+
+    // false forces the scalar kernels.
+    static void setSimd(bool enabled);
+    static bool simd();
+
+    static double sum(const double* x, std::size_t count);
+    static double dot(const double* x, const double* y, std::size_t count);
+    // 'count' must not be zero, the result is unspecified when 'x' holds a NaN.
+    static double min(const double* x, std::size_t count);
+    static double max(const double* x, std::size_t count);
+
+    // x = factor * x
+    static void scale(double* x, double factor, std::size_t count);
+    // y = alpha * x + y
+    static void axpy(double alpha, const double* x, double* y, std::size_t count);
+
+    // out = x <op> y, element by element, 'out' may be 'x' or 'y'.
+    static void add(double* out, const double* x, const double* y, std::size_t count);
+    static void subtract(double* out, const double* x, const double* y, std::size_t count);
+    static void multiply(double* out, const double* x, const double* y, std::size_t count);
+    static void divide(double* out, const double* x, const double* y, std::size_t count);
+};
+
+#endif //LOXPLUS_KERNELS_H
@@ -8,10 +8,24 @@
 #include "Parser.h"
 #include "Interpreter.h"
 #include "Resolver.h"
+#include "EscapeAnalysis.h"
+#include "Environment.h"
+#include "AllocationProfiler.h"
+#include "ExecutionCounts.h"
+#include "Fiber.h"
+#include "Heap.h"
+#include "HeapSnapshot.h"
+#include "Kernels.h"
+#include "Output.h"
+#include "Profiler.h"
+#include "Stats.h"
 #include <fstream>
+#include <pthread.h>
 
 using namespace std::string_literals;
 
+LoxPlus::Options LoxPlus::options;
+
 void LoxPlus::runPrompt()
 {
     runFile("test.lox");
@@ -41,16 +55,127 @@ int LoxPlus::runFile(const char* name)
 
 void LoxPlus::run(std::string_view source)
 {
+    // the tree-walking interpreter nests several native frames per Lox call,
+    // so it runs on a thread whose stack is sized after the call depth limit.
+    constexpr std::size_t stackPerCall = 16 * 1024;
+    constexpr std::size_t minimumStack = 8 * 1024 * 1024;
+
+    auto stackSize = std::max(minimumStack, options.maxCallDepth * stackPerCall);
+
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, stackSize);
+
+    pthread_t thread;
+    auto task = [](void* data) -> void* {
+        interpret(*static_cast<std::string_view*>(data));
+        return nullptr;
+    };
+
+    if (pthread_create(&thread, &attributes, task, &source) == 0)
+    {
+        pthread_join(thread, nullptr);
+    }
+    else
+    {
+        // the native stack guard still turns an overflow into a runtime error.
+        interpret(source);
+    }
+
+    pthread_attr_destroy(&attributes);
+}
+
+void LoxPlus::interpret(std::string_view source)
+{
+    Stats::enabled = options.stats != Options::Stats::None;
+    ExecutionCounts::enabled = options.counts;
+    AllocationProfiler::enabled = options.allocationProfile;
+    Heap::setSliceBudget(options.gcSliceBudget);
+    Heap::setConcurrent(options.gcConcurrent);
+    Kernels::setSimd(options.simd);
+    Fiber::setStackSize(options.generatorStack * 1024);
+    HeapSnapshot::installSignalHandler();
+    Output::configure(options.outputBuffer, options.flush == Options::Flush::Line || (options.flush == Options::Flush::Auto && Output::terminal()));
+
+    if (options.profile.empty())
+    {
+        execute(source);
+    }
+    else
+    {
+        constexpr long samplingInterval = 1000;
+
+        Profiler::start(samplingInterval);
+        execute(source);
+        Profiler::stop();
+    }
+
+    // the reports go to stderr, after the output of the script.
+    Output::flush();
+
+    if (!options.profile.empty())
+    {
+        std::ofstream collapsed { options.profile };
+        Profiler::report(collapsed, std::cerr, 20);
+    }
+
+    if (AllocationProfiler::enabled)
+    {
+        AllocationProfiler::report(std::cerr, 20);
+    }
+
+    if (ExecutionCounts::enabled)
+    {
+        ExecutionCounts::report(std::cerr, source, 30);
+    }
+
+    if (Stats::enabled)
+    {
+        Stats::count("environments", Stats::counter<Environment>().created);
+
+        auto & heap = Heap::statistics();
+        Stats::count("heap_allocations", heap.allocatedObjects);
+        Stats::count("minor_collections", heap.minorCollections);
+        Stats::count("major_collections", heap.majorCollections);
+        Stats::count("promoted_bytes", heap.promotedBytes);
+        Stats::count("pinned_objects", heap.pinnedObjects);
+        Stats::count("gc_pause_us", static_cast<std::size_t>(heap.pauseMilliseconds * 1000));
+        Stats::count("gc_max_pause_us", static_cast<std::size_t>(heap.maxPauseMilliseconds * 1000));
+        Stats::count("gc_concurrent_mark_us", static_cast<std::size_t>(heap.concurrentMarkMilliseconds * 1000));
+
+        std::vector<std::pair<std::string, std::size_t>> pauses;
+        for (std::size_t bucket = 0; bucket < Heap::pauseBuckets; bucket++)
+        {
+            if (heap.pauses[bucket] == 0) continue;
+
+            auto last = bucket + 1 == Heap::pauseBuckets;
+            auto label = last ? ">=" + std::to_string(Heap::pauseBucketLimit(bucket - 1)) : "<" + std::to_string(Heap::pauseBucketLimit(bucket));
+            pauses.emplace_back(label, heap.pauses[bucket]);
+        }
+        Stats::histogram("gc_pause_histogram_us", std::move(pauses));
+        Stats::report(std::cerr, options.stats == Options::Stats::Json);
+    }
+}
+
+void LoxPlus::execute(std::string_view source)
+{
+    Stats::beginPhase("scan");
     Scanner scanner(source);
     auto tokens = scanner.scanTokens();
+    Stats::count("tokens", tokens.size());
 
+    Stats::beginPhase("parse");
+    auto nodes = Stats::objects();
     Parser parser(tokens);
     auto statements = parser.parse();
+    Stats::count("nodes", Stats::objects() - nodes);
 
     // Stop if there was a syntax error.
     if (hadError) return;
 
+    Stats::beginPhase("resolve");
     Interpreter interpreter;
+    interpreter.setMaxCallDepth(options.maxCallDepth);
 
     Resolver resolver(interpreter);
     resolver.resolve(statements);
@@ -58,7 +183,17 @@ void LoxPlus::run(std::string_view source)
     // Stop if there was a resolution error.
     if (hadError) return;
 
+    Stats::beginPhase("analyse");
+    EscapeAnalysis escapeAnalysis(interpreter);
+    escapeAnalysis.analyse(statements);
+
+    Stats::beginPhase("interpret");
+    AllocationProfiler::attach(&interpreter);
+    Heap::attach(&interpreter);
     interpreter.interpret(statements);
+    Heap::attach(nullptr);
+    AllocationProfiler::attach(nullptr);
+    Stats::endPhase();
 }
 
 void LoxPlus::error(std::size_t line, std::string_view message)
@@ -68,7 +203,7 @@ void LoxPlus::error(std::size_t line, std::string_view message)
 
 void LoxPlus::report(std::size_t line, std::string_view where, std::string_view message)
 {
-    std::cout << "[line " << line << "] Error" << where << ": " << message << '\n';
+    Output::line("[line " + std::to_string(line) + "] Error" + std::string { where } + ": " + std::string { message });
     hadError = true;
 }
 
@@ -86,6 +221,6 @@ void LoxPlus::error(const Token & token, std::string_view message)
 
 void LoxPlus::runtimeError(const RuntimeError & error)
 {
-    std::cout << "[line " << error.token.line << "] " << error.what() << '\n';
+    Output::line("[line " + std::to_string(error.token.line) + "] " + error.what());
     hadRuntimeError = true;
 }
@@ -5,6 +5,7 @@
 #ifndef LOXPLUS_LOXPLUS_H
 #define LOXPLUS_LOXPLUS_H
 
+#include <string>
 #include <string_view>
 #include "RuntimeError.h"
 
@@ -13,6 +14,43 @@ class Token;
 class LoxPlus
 {
 public:
+    struct Options
+    {
+        // maximum number of nested Lox calls before a "Stack overflow." error.
+        std::size_t maxCallDepth = 10000;
+
+        // --stats prints the phase timings and allocation counts to stderr after the run.
+        enum class Stats { None, Text, Json } stats = Stats::None;
+
+        // --profile writes the sampled stacks to this file and the hottest functions and lines to stderr.
+        std::string profile;
+
+        // --counts prints exact execution counts and the annotated source to stderr after the run.
+        bool counts = false;
+
+        // --alloc-profile prints the top allocation sites to stderr after the run.
+        bool allocationProfile = false;
+
+        // --gc-slice splits the major collections in slices marking or sweeping that many objects.
+        std::size_t gcSliceBudget = 0;
+
+        // --gc-concurrent marks the old generation on a helper thread while the script runs.
+        bool gcConcurrent = false;
+
+        // --generator-stack is the size in KiB of the native stack of each generator started.
+        std::size_t generatorStack = 2048;
+
+        // --no-simd runs the Float64Array natives with the scalar kernels.
+        bool simd = true;
+
+        // --output-buffer is how many bytes of output are kept before being written, 0 writes them at once.
+        std::size_t outputBuffer = 64 * 1024;
+
+        // --flush=line writes the output after each line, --flush=size when the buffer is full.
+        // Auto flushes the lines when stdout is a terminal.
+        enum class Flush { Auto, Line, Size } flush = Flush::Auto;
+    };
+
     LoxPlus() = delete;
 
     static int runFile(const char*  name);
@@ -24,8 +62,12 @@ public:
 
     static void runtimeError(const RuntimeError & error);
 
+    static Options options;
+
 private:
     static void report(std::size_t line, std::string_view where, std::string_view message);
+    static void interpret(std::string_view source);
+    static void execute(std::string_view source);
 
     static inline bool hadError = false;
     static inline bool hadRuntimeError = false;
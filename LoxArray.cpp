@@ -0,0 +1,81 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "LoxArray.h"
+#include "Heap.h"
+#include <algorithm>
+
+namespace
+{
+    // arrays being printed, a nested reference to one of them is shown as "[...]".
+    std::vector<const LoxArray*> printing;
+}
+
+LoxArray::LoxArray(std::vector<Object> elements)
+    : elements { std::move(elements) }
+{
+}
+
+void LoxArray::set(std::size_t index, Object value)
+{
+    Heap::Mutation mutation { this };
+    mutation.store(elements[index], std::move(value));
+}
+
+void LoxArray::push(Object value)
+{
+    // the concurrent marker must not see the storage being reallocated.
+    Heap::Mutation mutation { this };
+    mutation.store(elements.emplace_back(), std::move(value));
+}
+
+Object LoxArray::pop()
+{
+    if (elements.empty()) return Object {};
+
+    Heap::Mutation mutation { this };
+    auto value = elements.back();
+    mutation.store(elements.back(), Object {});
+    elements.pop_back();
+    return value;
+}
+
+std::string LoxArray::toString() const
+{
+    if (std::find(printing.begin(), printing.end(), this) != printing.end()) return "[...]";
+
+    printing.push_back(this);
+    std::string string = "[";
+    for (std::size_t i = 0; i < elements.size(); i++)
+    {
+        if (i != 0) string += ", ";
+        string += to_string(elements[i]);
+    }
+    printing.pop_back();
+
+    return string + "]";
+}
+
+void LoxArray::trace(Tracer & tracer)
+{
+    for (auto & element : elements)
+    {
+        tracer.trace(element);
+    }
+}
+
+std::size_t LoxArray::heapSize() const
+{
+    return sizeof(*this) + elements.capacity() * sizeof(Object);
+}
+
+std::string LoxArray::describe() const
+{
+    return "Array [" + std::to_string(elements.size()) + "]";
+}
+
+HeapObject* LoxArray::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
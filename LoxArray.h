@@ -0,0 +1,43 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_LOXARRAY_H
+#define LOXPLUS_LOXARRAY_H
+
+#include <string>
+#include <vector>
+#include "CreatableType.h"
+#include "HeapObject.h"
+#include "Object.h"
+
+/*
+ * Built-in array, the elements are stored contiguously. Indices are
+ * checked by the callers: get and set expect one below size().
+ * */
+class LoxArray : public HeapObject, public CreatableType<LoxArray>
+{
+public:
+    explicit LoxArray(std::vector<Object> elements);
+
+    std::size_t size() const { return elements.size(); }
+    const Object & get(std::size_t index) const { return elements[index]; }
+    void set(std::size_t index, Object value);
+
+    // amortised O(1), the storage doubles when it is full.
+    void push(Object value);
+    // nil when the array is empty.
+    Object pop();
+
+    std::string toString() const;
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
+private:
+    std::vector<Object> elements;
+};
+
+#endif //LOXPLUS_LOXARRAY_H
@@ -6,6 +6,7 @@
 #define LOXPLUS_LOXCALLABLE_H
 
 #include <vector>
+#include "Arguments.h"
 #include "Object.h"
 #include "Interpreter.h"
 
@@ -18,7 +19,7 @@ public:
     LoxCallable & operator=(LoxClass &&) = delete;
 
     virtual ~LoxCallable() = default;
-    virtual Object call(Interpreter & interpreter, std::vector<Object> arguments) = 0;
+    virtual Object call(Interpreter & interpreter, Arguments arguments) = 0;
     virtual int arity() const = 0;
 
     virtual std::string getName() const = 0;
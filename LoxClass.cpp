@@ -6,15 +6,18 @@
 #include "LoxInstance.h"
 #include "LoxFunction.h"
 
-LoxClass::LoxClass(std::string name, std::map<std::string, LoxFunction*> && methods)
-    : name { std::move(name) }, methods { std::move(methods) }
+LoxClass::LoxClass(std::string name, ClassStmt* declaration, std::map<std::string, LoxFunction*> && methods)
+    : name { std::move(name) }, declaration { declaration }, methods { std::move(methods) }
 {
 }
 
-Object LoxClass::call(Interpreter & interpreter, std::vector<Object> arguments)
+Object LoxClass::call(Interpreter & interpreter, Arguments arguments)
 {
-    auto instance = LoxInstance::create(this);
+    return construct(interpreter, arguments, LoxInstance::create(this));
+}
 
+Object LoxClass::construct(Interpreter & interpreter, Arguments arguments, LoxInstance* instance)
+{
     if (methods.count("init"))
     {
         auto initializer = methods["init"];
@@ -42,3 +45,32 @@ LoxFunction* LoxClass::findMethod(LoxInstance* instance, std::string name)
 
     return nullptr;
 }
+
+LoxFunction* LoxClass::getMethod(const std::string & name) const
+{
+    auto it = methods.find(name);
+    return it != methods.end() ? it->second : nullptr;
+}
+
+void LoxClass::trace(Tracer & tracer)
+{
+    for (auto & [name, method] : methods)
+    {
+        tracer.trace(method);
+    }
+}
+
+std::size_t LoxClass::heapSize() const
+{
+    return sizeof(*this) + mapSize(methods);
+}
+
+std::string LoxClass::describe() const
+{
+    return "class " + name;
+}
+
+HeapObject* LoxClass::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
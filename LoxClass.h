@@ -7,20 +7,33 @@
 
 #include <string>
 #include "LoxCallable.h"
+#include "HeapObject.h"
 
-class LoxClass : public CreatableType<LoxClass>, public LoxCallable
+class LoxClass : public HeapObject, public CreatableType<LoxClass>, public LoxCallable
 {
 public:
-    LoxClass(std::string name, std::map<std::string, LoxFunction*> && methods);
-    Object call(Interpreter & interpreter, std::vector<Object> arguments) override;
+    LoxClass(std::string name, ClassStmt* declaration, std::map<std::string, LoxFunction*> && methods);
+    Object call(Interpreter & interpreter, Arguments arguments) override;
     int arity() const override;
 
+    // runs the initializer on an already allocated instance.
+    Object construct(Interpreter & interpreter, Arguments arguments, LoxInstance* instance);
+
     LoxFunction* findMethod(LoxInstance* instance, std::string name);
+    // unbound method, nullptr if the class does not have one with this name.
+    LoxFunction* getMethod(const std::string & name) const;
 
     std::string getName() const override { return name; }
+    ClassStmt* getDeclaration() const { return declaration; }
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
 
 private:
     std::string name;
+    ClassStmt* declaration;
     std::map<std::string, LoxFunction*> methods;
 };
 
@@ -0,0 +1,175 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "LoxFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LoxFile* LoxFile::open(std::string path)
+{
+    auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0) return nullptr;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        ::close(descriptor);
+        return nullptr;
+    }
+
+    // an empty file cannot be mapped, it has no lines anyway.
+    auto size = static_cast<std::size_t>(status.st_size);
+    void* data = nullptr;
+    if (size != 0)
+    {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    }
+    ::close(descriptor);
+    if (data == MAP_FAILED) return nullptr;
+
+    if (data != nullptr) madvise(data, size, MADV_SEQUENTIAL);
+
+    return create(std::move(path), static_cast<const char*>(data), size);
+}
+
+bool LoxFile::readAll(const std::string & path, std::string & content)
+{
+    auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0) return false;
+
+    // sized once from the file, only files growing meanwhile are read in several steps.
+    struct stat status;
+    std::string buffer;
+    if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode)) buffer.resize(static_cast<std::size_t>(status.st_size));
+
+    std::size_t length = 0;
+    while (true)
+    {
+        if (length == buffer.size()) buffer.resize(std::max<std::size_t>(buffer.size() * 2, 64 * 1024));
+
+        auto count = read(descriptor, &buffer[length], buffer.size() - length);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0)
+        {
+            ::close(descriptor);
+            if (count < 0) return false;
+
+            buffer.resize(length);
+            content = std::move(buffer);
+            return true;
+        }
+        length += static_cast<std::size_t>(count);
+    }
+}
+
+bool LoxFile::writeAll(const std::string & path, std::string_view content)
+{
+    auto descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (descriptor < 0) return false;
+
+    while (!content.empty())
+    {
+        auto count = write(descriptor, content.data(), content.size());
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0)
+        {
+            ::close(descriptor);
+            return false;
+        }
+        content.remove_prefix(static_cast<std::size_t>(count));
+    }
+
+    return ::close(descriptor) == 0;
+}
+
+LoxFile::LoxFile(std::string path, const char* data, std::size_t size)
+    : path { std::move(path) }, data { data }, size { size }
+{
+}
+
+LoxFile::LoxFile(LoxFile && other) noexcept
+    : path { std::move(other.path) }, data { std::exchange(other.data, nullptr) }, size { std::exchange(other.size, 0) }, cursor { other.cursor }
+{
+}
+
+LoxFile::~LoxFile()
+{
+    close();
+}
+
+std::optional<std::string_view> LoxFile::nextLine()
+{
+    if (cursor >= size) return std::nullopt;
+
+    return lineAt(cursor);
+}
+
+std::optional<std::string_view> LoxFile::findLine(std::string_view needle)
+{
+    if (cursor >= size) return std::nullopt;
+
+    auto position = std::string_view { data, size }.find(needle, cursor);
+    if (position == std::string_view::npos)
+    {
+        cursor = size;
+        return std::nullopt;
+    }
+
+    return lineAt(position);
+}
+
+std::string_view LoxFile::lineAt(std::size_t position)
+{
+    std::string_view content { data, size };
+
+    // the cursor is always at the start of a line.
+    auto start = cursor;
+    if (position > cursor)
+    {
+        auto previous = content.rfind('\n', position - 1);
+        if (previous != std::string_view::npos && previous >= cursor) start = previous + 1;
+    }
+
+    auto end = content.find('\n', position);
+    if (end == std::string_view::npos) end = size;
+    cursor = end + 1;
+
+    auto line = content.substr(start, end - start);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    return line;
+}
+
+void LoxFile::close()
+{
+    if (data != nullptr) munmap(const_cast<char*>(data), size);
+
+    data = nullptr;
+    size = 0;
+    cursor = 0;
+}
+
+void LoxFile::trace(Tracer & tracer)
+{
+}
+
+std::size_t LoxFile::heapSize() const
+{
+    // the mapping is in the page cache, not in the heap.
+    return sizeof(*this) + path.capacity();
+}
+
+std::string LoxFile::describe() const
+{
+    return "File " + path;
+}
+
+HeapObject* LoxFile::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
@@ -0,0 +1,62 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_LOXFILE_H
+#define LOXPLUS_LOXFILE_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include "CreatableType.h"
+#include "HeapObject.h"
+
+/*
+ * File opened for reading, mapped in memory and read a line at a time.
+ * The lines are views of the mapping: only the ones handed to Lox are
+ * copied into strings, findLine() skips the others without copying them.
+ * The mapping is released by close() or when the file is collected.
+ * */
+class LoxFile : public HeapObject, public CreatableType<LoxFile>
+{
+public:
+    // nullptr when 'path' cannot be opened or mapped.
+    static LoxFile* open(std::string path);
+    // the whole file read at once, false when it cannot be read.
+    static bool readAll(const std::string & path, std::string & content);
+    // replaces the file, false when it cannot be written.
+    static bool writeAll(const std::string & path, std::string_view content);
+
+    LoxFile(std::string path, const char* data, std::size_t size);
+    LoxFile(LoxFile && other) noexcept;
+    ~LoxFile() override;
+
+    LoxFile(const LoxFile &) = delete;
+    LoxFile & operator=(const LoxFile &) = delete;
+
+    // the next line without its line break, nullopt after the last one.
+    std::optional<std::string_view> nextLine();
+    // the next line containing 'needle', the lines before it are skipped.
+    std::optional<std::string_view> findLine(std::string_view needle);
+    // the following reads find no more lines.
+    void close();
+
+    const std::string & getPath() const { return path; }
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
+private:
+    std::string path;
+    // nullptr when the file is empty or closed.
+    const char* data;
+    std::size_t size;
+    std::size_t cursor = 0;
+
+    // the line around 'position', the cursor moves to the next one.
+    std::string_view lineAt(std::size_t position);
+};
+
+#endif //LOXPLUS_LOXFILE_H
@@ -0,0 +1,42 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "LoxFloat64Array.h"
+#include "Numbers.h"
+
+LoxFloat64Array::LoxFloat64Array(std::vector<double> elements)
+    : elements { std::move(elements) }
+{
+}
+
+std::string LoxFloat64Array::toString() const
+{
+    std::string string = "[";
+    for (std::size_t i = 0; i < elements.size(); i++)
+    {
+        if (i != 0) string += ", ";
+        string += Numbers::format(elements[i]);
+    }
+
+    return string + "]";
+}
+
+void LoxFloat64Array::trace(Tracer & tracer)
+{
+}
+
+std::size_t LoxFloat64Array::heapSize() const
+{
+    return sizeof(*this) + elements.capacity() * sizeof(double);
+}
+
+std::string LoxFloat64Array::describe() const
+{
+    return "Float64Array [" + std::to_string(elements.size()) + "]";
+}
+
+HeapObject* LoxFloat64Array::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
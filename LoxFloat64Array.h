@@ -0,0 +1,39 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_LOXFLOAT64ARRAY_H
+#define LOXPLUS_LOXFLOAT64ARRAY_H
+
+#include <string>
+#include <vector>
+#include "CreatableType.h"
+#include "HeapObject.h"
+
+/*
+ * Fixed size array of numbers stored as raw doubles, for the Kernels
+ * natives. It holds no references, the collector never looks inside.
+ * Indices are checked by the callers like for LoxArray.
+ * */
+class LoxFloat64Array : public HeapObject, public CreatableType<LoxFloat64Array>
+{
+public:
+    explicit LoxFloat64Array(std::vector<double> elements);
+
+    std::size_t size() const { return elements.size(); }
+    double* data() { return elements.data(); }
+    double get(std::size_t index) const { return elements[index]; }
+    void set(std::size_t index, double value) { elements[index] = value; }
+
+    std::string toString() const;
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
+private:
+    std::vector<double> elements;
+};
+
+#endif //LOXPLUS_LOXFLOAT64ARRAY_H
@@ -4,34 +4,82 @@
 
 #include "LoxFunction.h"
 #include "Return.h"
+#include "LoxGenerator.h"
 #include "LoxInstance.h"
 
-LoxFunction::LoxFunction(FunctionStmt* declaration, Environment* closure, bool isInitializer)
-    : declaration { declaration }, closure { closure }, isInitializer { isInitializer }
+LoxFunction::LoxFunction(FunctionStmt* declaration, Environment* closure, bool isInitializer, bool isGenerator)
+    : declaration { declaration }, closure { closure }, isInitializer { isInitializer }, isGenerator { isGenerator }
 {
 
 }
 
-Object LoxFunction::call(Interpreter & interpreter, std::vector<Object> arguments)
+Object LoxFunction::call(Interpreter & interpreter, Arguments arguments)
 {
-    auto environment = Environment::create(closure);
-    int i = 0;
-    for (auto & parameter : declaration->parameters)
-    {
-        environment->define(parameter.lexeme, arguments[i++]);
-    }
+    if (isGenerator) return LoxGenerator::create(this, arguments);
+    return invoke(interpreter, arguments);
+}
+
+Object LoxFunction::invoke(Interpreter & interpreter, Arguments arguments)
+{
+    interpreter.frames.push_back({ this, closure, interpreter.currentLine });
 
     try
     {
-        interpreter.executeBlock(declaration->body, environment);
+        auto result = run(interpreter, arguments);
+        interpreter.currentLine = interpreter.frames.back().line;
+        interpreter.frames.pop_back();
+        return result;
     }
-    catch (const Return & returnValue)
+    catch (...)
     {
-        return returnValue.value;
+        interpreter.currentLine = interpreter.frames.back().line;
+        interpreter.frames.pop_back();
+        throw;
     }
+}
+
+Object LoxFunction::run(Interpreter & interpreter, Arguments arguments)
+{
+    auto function = this;
+    std::array<Object, Arguments::capacity> pending;
+
+    // tail calls loop here instead of growing the native stack.
+    while (true)
+    {
+        auto environment = Environment::create(function->closure);
+        int i = 0;
+        for (auto & parameter : function->declaration->parameters)
+        {
+            environment->define(parameter.lexeme, arguments[i++]);
+        }
+        interpreter.frames.back().function = function;
+        interpreter.frames.back().environment = environment;
+
+        // the return ending the body comes back without an exception, the others throw it.
+        Return result { nullptr };
+        bool returned;
+        try
+        {
+            returned = interpreter.executeBody(function->declaration->body, environment, result);
+        }
+        catch (Return & returnValue)
+        {
+            result = std::move(returnValue);
+            returned = true;
+        }
+
+        if (!returned)
+        {
+            if (function->isInitializer) return function->closure->getAt(0, "this");
+            return Object();
+        }
+        if (result.tailCall == nullptr) return result.value;
 
-    if (isInitializer) return closure->getAt(0, "this");
-    return Object();
+        function = result.tailCall;
+        std::move(result.arguments.begin(), result.arguments.begin() + result.arity, pending.begin());
+        arguments = Arguments { pending.data(), result.arity };
+        if (function->isGenerator) return LoxGenerator::create(function, arguments);
+    }
 }
 
 int LoxFunction::arity() const
@@ -44,5 +92,25 @@ LoxFunction* LoxFunction::bind(LoxInstance* instance)
 {
     auto environment = Environment::create(closure);
     environment->define("this", instance);
-    return LoxFunction::create(declaration, environment, isInitializer);
+    return LoxFunction::create(declaration, environment, isInitializer, isGenerator);
+}
+
+void LoxFunction::trace(Tracer & tracer)
+{
+    tracer.trace(closure);
+}
+
+std::size_t LoxFunction::heapSize() const
+{
+    return sizeof(*this);
+}
+
+std::string LoxFunction::describe() const
+{
+    return "fun " + declaration->name.lexeme;
+}
+
+HeapObject* LoxFunction::relocate(void* memory)
+{
+    return moveTo(*this, memory);
 }
@@ -6,14 +6,18 @@
 #define LOXPLUS_LOXFUNCTION_H
 
 #include "LoxCallable.h"
+#include "HeapObject.h"
 
 class LoxInstance;
 
-class LoxFunction : public CreatableType<LoxFunction>, public LoxCallable
+class LoxFunction : public HeapObject, public CreatableType<LoxFunction>, public LoxCallable
 {
 public:
-    LoxFunction(FunctionStmt* declaration, Environment* closure, bool isInitializer);
-    Object call(Interpreter & interpreter, std::vector<Object> arguments) override;
+    LoxFunction(FunctionStmt* declaration, Environment* closure, bool isInitializer, bool isGenerator);
+    // a generator function returns a generator, which runs the body later.
+    Object call(Interpreter & interpreter, Arguments arguments) override;
+    // runs the body now, in a new frame.
+    Object invoke(Interpreter & interpreter, Arguments arguments);
     int arity() const override;
 
     LoxFunction(const LoxFunction &) = delete;
@@ -26,11 +30,21 @@ public:
     LoxFunction* bind(LoxInstance* instance);
 
     std::string getName() const override { return "<fun>"; }
+    FunctionStmt* getDeclaration() const { return declaration; }
+    Environment* getClosure() const { return closure; }
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
 
 private:
+    Object run(Interpreter & interpreter, Arguments arguments);
+
     FunctionStmt* declaration;
     Environment* closure;
     bool isInitializer;
+    bool isGenerator;
 };
 
 
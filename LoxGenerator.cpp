@@ -0,0 +1,144 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "LoxGenerator.h"
+#include "Fiber.h"
+#include "Heap.h"
+#include "LoxFunction.h"
+#include "NativeError.h"
+#include <new>
+
+namespace
+{
+    // keep enough of the fiber's stack below the limit to unwind and report the error.
+    constexpr std::size_t safetyMargin = 64 * 1024;
+}
+
+LoxGenerator::LoxGenerator(LoxFunction* function, Arguments arguments)
+    : function { function }
+{
+    // start() finds the function and its arguments on the value stack.
+    context.stack.reserve(arguments.size() + 1);
+    context.stack.push_back(function);
+    context.stack.insert(context.stack.end(), arguments.begin(), arguments.end());
+    context.environment = function->getClosure();
+    context.generator = this;
+}
+
+LoxGenerator::LoxGenerator(LoxGenerator && other) noexcept = default;
+
+LoxGenerator::~LoxGenerator() = default;
+
+Object LoxGenerator::resume(Interpreter & interpreter)
+{
+    if (state == State::Running)
+    {
+        throw NativeError("Generator is already running.");
+    }
+    if (state == State::Done) return Object {};
+
+    if (fiber == nullptr)
+    {
+        // out of address space or of mappings, the generator can be resumed again later.
+        try
+        {
+            fiber = std::make_unique<Fiber>(&LoxGenerator::start, &interpreter);
+        }
+        catch (const std::bad_alloc &)
+        {
+            throw NativeError("Cannot allocate a generator stack.");
+        }
+        context.nativeStackLimit = fiber->stackLimit() + safetyMargin;
+    }
+
+    state = State::Running;
+    swap(interpreter);
+    try
+    {
+        fiber->resume();
+    }
+    catch (...)
+    {
+        swap(interpreter);
+        finish();
+        throw;
+    }
+
+    Object value;
+    if (!fiber->finished())
+    {
+        value = std::move(interpreter.stack.back());
+        interpreter.stack.pop_back();
+    }
+    swap(interpreter);
+
+    if (fiber->finished())
+    {
+        finish();
+    }
+    else
+    {
+        state = State::Suspended;
+    }
+    return value;
+}
+
+void LoxGenerator::yield(Interpreter & interpreter, Object value)
+{
+    // taken back from the value stack by resume().
+    interpreter.stack.push_back(std::move(value));
+    Fiber::suspend();
+}
+
+void LoxGenerator::start(void* argument)
+{
+    auto & interpreter = *static_cast<Interpreter*>(argument);
+
+    // the generator itself is never referenced from its own stack, nothing keeps it alive but its users.
+    auto & stack = interpreter.stack;
+    stack[0].asFunction()->invoke(interpreter, Arguments { stack.data() + 1, stack.size() - 1 });
+    stack.clear();
+}
+
+void LoxGenerator::swap(Interpreter & interpreter)
+{
+    {
+        Heap::Mutation mutation { this };
+        mutation.discardFields();
+        interpreter.swapContext(context);
+    }
+    Heap::remember(this);
+}
+
+void LoxGenerator::finish()
+{
+    state = State::Done;
+    fiber.reset();
+
+    // an error leaves the values being computed behind.
+    Heap::Mutation mutation { this };
+    mutation.discardFields();
+    context.stack.clear();
+}
+
+void LoxGenerator::trace(Tracer & tracer)
+{
+    tracer.trace(function);
+    context.trace(tracer);
+}
+
+std::size_t LoxGenerator::heapSize() const
+{
+    return sizeof(*this) + context.stack.capacity() * sizeof(Object) + context.frames.capacity() * sizeof(Interpreter::CallFrame);
+}
+
+std::string LoxGenerator::describe() const
+{
+    return "generator " + function->getDeclaration()->name.lexeme;
+}
+
+HeapObject* LoxGenerator::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
@@ -0,0 +1,62 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_LOXGENERATOR_H
+#define LOXPLUS_LOXGENERATOR_H
+
+#include <memory>
+#include <string>
+#include "Arguments.h"
+#include "CreatableType.h"
+#include "HeapObject.h"
+#include "Interpreter.h"
+
+class Fiber;
+class LoxFunction;
+
+/*
+ * What calling a function whose body yields returns. The body runs on a
+ * fiber of its own, with its own value stack and call frames: resuming
+ * the generator swaps them with the interpreter's and switches to the
+ * fiber until the next yield, whose value it returns, or the end of the
+ * body. The fiber is only created by the first resume, and released at
+ * the end, an abandoned generator drops it with the rest.
+ * */
+class LoxGenerator : public HeapObject, public CreatableType<LoxGenerator>
+{
+public:
+    LoxGenerator(LoxFunction* function, Arguments arguments);
+    LoxGenerator(LoxGenerator && other) noexcept;
+    ~LoxGenerator() override;
+
+    LoxGenerator(const LoxGenerator &) = delete;
+    LoxGenerator & operator=(const LoxGenerator &) = delete;
+
+    // the next value yielded, nil once the body returned. An error raised by the body ends the generator.
+    Object resume(Interpreter & interpreter);
+    bool done() const { return state == State::Done; }
+
+    // from the body of the generator running, hands 'value' to the one resuming it.
+    static void yield(Interpreter & interpreter, Object value);
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
+private:
+    enum class State { Suspended, Running, Done };
+
+    LoxFunction* function;
+    Interpreter::Context context;
+    std::unique_ptr<Fiber> fiber;
+    State state = State::Suspended;
+
+    static void start(void* interpreter);
+    // between the interpreter's state and the generator's one.
+    void swap(Interpreter & interpreter);
+    void finish();
+};
+
+#endif //LOXPLUS_LOXGENERATOR_H
@@ -5,6 +5,7 @@
 #include "LoxInstance.h"
 #include "RuntimeError.h"
 #include "LoxFunction.h"
+#include "Heap.h"
 
 LoxInstance::LoxInstance(LoxClass* klass)
     : klass { klass }
@@ -29,5 +30,30 @@ Object LoxInstance::get(Token name)
 
 void LoxInstance::set(Token name, Object value)
 {
-    fields[name.lexeme] = std::move(value);
+    Heap::Mutation mutation { this };
+    mutation.store(fields[name.lexeme], std::move(value));
+}
+
+void LoxInstance::trace(Tracer & tracer)
+{
+    tracer.trace(klass);
+    for (auto & [name, value] : fields)
+    {
+        tracer.trace(value);
+    }
+}
+
+std::size_t LoxInstance::heapSize() const
+{
+    return sizeof(*this) + mapSize(fields);
+}
+
+std::string LoxInstance::describe() const
+{
+    return klass->getName() + " instance";
+}
+
+HeapObject* LoxInstance::relocate(void* memory)
+{
+    return moveTo(*this, memory);
 }
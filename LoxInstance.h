@@ -6,19 +6,26 @@
 #define LOXPLUS_LOXINSTANCE_H
 
 #include "LoxClass.h"
+#include "HeapObject.h"
 
 class Token;
 
-class LoxInstance : public CreatableType<LoxInstance>
+class LoxInstance : public HeapObject, public CreatableType<LoxInstance>
 {
 public:
     explicit LoxInstance(LoxClass* klass);
 
     Object get(Token name);
     void set(Token name, Object value);
+    bool hasField(const std::string & name) const { return fields.count(name) != 0; }
 
     LoxClass* getClass() const { return klass; }
 
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
 private:
     LoxClass* klass;
     std::map<std::string, Object> fields;
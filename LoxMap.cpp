@@ -0,0 +1,204 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "LoxMap.h"
+#include "Heap.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace
+{
+    constexpr std::size_t minimumCapacity = 8;
+
+    // maps being printed, a nested reference to one of them is shown as "{...}".
+    std::vector<const LoxMap*> printing;
+}
+
+bool LoxMap::isValidKey(const Object & key)
+{
+    return key.isString() || key.isBool() || (key.isDouble() && !std::isnan(key.asDouble()));
+}
+
+const Object* LoxMap::find(const Object & key) const
+{
+    if (entries.empty()) return nullptr;
+
+    auto & entry = entries[slot(key, hash(key))];
+    return entry.live() ? &entry.value : nullptr;
+}
+
+void LoxMap::set(const Object & key, Object value)
+{
+    // growing reallocates the entries the concurrent marker reads.
+    Heap::Mutation mutation { this };
+
+    if ((used + 1) * 4 > entries.size() * 3) grow();
+
+    auto keyHash = hash(key);
+    auto & entry = entries[slot(key, keyHash)];
+    if (!entry.live())
+    {
+        if (entry.hash == emptyHash) used++;
+        count++;
+        entry.hash = keyHash;
+        mutation.store(entry.key, key);
+    }
+    mutation.store(entry.value, std::move(value));
+}
+
+bool LoxMap::remove(const Object & key)
+{
+    if (entries.empty()) return false;
+
+    auto & entry = entries[slot(key, hash(key))];
+    if (!entry.live()) return false;
+
+    Heap::Mutation mutation { this };
+    entry.hash = tombstoneHash;
+    mutation.store(entry.key, Object {});
+    mutation.store(entry.value, Object {});
+    count--;
+    return true;
+}
+
+std::vector<Object> LoxMap::keys() const
+{
+    std::vector<Object> keys;
+    keys.reserve(count);
+    for (auto & entry : entries)
+    {
+        if (entry.live()) keys.push_back(entry.key);
+    }
+
+    return keys;
+}
+
+std::string LoxMap::toString() const
+{
+    if (std::find(printing.begin(), printing.end(), this) != printing.end()) return "{...}";
+
+    printing.push_back(this);
+    std::string string = "{";
+    for (auto & entry : entries)
+    {
+        if (!entry.live()) continue;
+
+        if (string.size() > 1) string += ", ";
+        string += to_string(entry.key) + ": " + to_string(entry.value);
+    }
+    printing.pop_back();
+
+    return string + "}";
+}
+
+std::size_t LoxMap::hash(const Object & key)
+{
+    std::size_t value;
+    if (key.isString())
+    {
+        value = std::hash<std::string> {}(key.asString());
+    }
+    else if (key.isDouble())
+    {
+        // 0 and -0 are the same key.
+        auto number = key.asDouble();
+        value = std::hash<double> {}(number == 0 ? 0.0 : number);
+    }
+    else
+    {
+        value = key.asBool() ? 1 : 2;
+    }
+
+    // the table keeps the low bits, make them depend on all the others.
+    std::uint64_t mixed = value;
+    mixed ^= mixed >> 33;
+    mixed *= 0xff51afd7ed558ccdULL;
+    mixed ^= mixed >> 33;
+    return std::max(static_cast<std::size_t>(mixed), tombstoneHash + 1);
+}
+
+bool LoxMap::sameKey(const Object & left, const Object & right)
+{
+    if (left.index() != right.index()) return false;
+    if (left.isString()) return left.asString() == right.asString();
+    if (left.isDouble()) return left.asDouble() == right.asDouble();
+    return left.asBool() == right.asBool();
+}
+
+std::size_t LoxMap::slot(const Object & key, std::size_t hash) const
+{
+    auto mask = entries.size() - 1;
+    auto tombstone = entries.size();
+
+    for (auto index = hash & mask;; index = (index + 1) & mask)
+    {
+        auto & entry = entries[index];
+        if (entry.hash == hash && sameKey(entry.key, key))
+        {
+            return index;
+        }
+        else if (entry.hash == emptyHash)
+        {
+            return tombstone != entries.size() ? tombstone : index;
+        }
+        else if (entry.hash == tombstoneHash && tombstone == entries.size())
+        {
+            tombstone = index;
+        }
+    }
+}
+
+void LoxMap::grow()
+{
+    // at most half full afterwards, tombstones are dropped.
+    auto capacity = minimumCapacity;
+    while (capacity < (count + 1) * 2)
+    {
+        capacity *= 2;
+    }
+
+    auto previous = std::exchange(entries, std::vector<Entry>(capacity));
+    used = count;
+
+    auto mask = capacity - 1;
+    for (auto & entry : previous)
+    {
+        if (!entry.live()) continue;
+
+        auto index = entry.hash & mask;
+        while (entries[index].hash != emptyHash)
+        {
+            index = (index + 1) & mask;
+        }
+        entries[index] = std::move(entry);
+    }
+}
+
+void LoxMap::trace(Tracer & tracer)
+{
+    for (auto & entry : entries)
+    {
+        if (!entry.live()) continue;
+
+        tracer.trace(entry.key);
+        tracer.trace(entry.value);
+    }
+}
+
+std::size_t LoxMap::heapSize() const
+{
+    return sizeof(*this) + entries.capacity() * sizeof(Entry);
+}
+
+std::string LoxMap::describe() const
+{
+    return "Map [" + std::to_string(count) + "]";
+}
+
+HeapObject* LoxMap::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
@@ -0,0 +1,71 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_LOXMAP_H
+#define LOXPLUS_LOXMAP_H
+
+#include <string>
+#include <vector>
+#include "CreatableType.h"
+#include "HeapObject.h"
+#include "Object.h"
+
+/*
+ * Hash table from strings, numbers or booleans to any value. It is open
+ * addressed with linear probing over a single array of entries, each one
+ * keeping the hash of its key: probing only compares the keys when the
+ * hashes match, and growing never hashes a key again. Removed entries
+ * become tombstones until the next growth.
+ * */
+class LoxMap : public HeapObject, public CreatableType<LoxMap>
+{
+public:
+    LoxMap() = default;
+
+    // whether 'key' can be used as a key, the others are rejected by the callers.
+    static bool isValidKey(const Object & key);
+
+    std::size_t size() const { return count; }
+    // nullptr when the key is absent.
+    const Object* find(const Object & key) const;
+    void set(const Object & key, Object value);
+    // false when the key was absent.
+    bool remove(const Object & key);
+    // in no particular order.
+    std::vector<Object> keys() const;
+
+    std::string toString() const;
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
+private:
+    // the hash of the key, or one of these for the entries without one.
+    static constexpr std::size_t emptyHash = 0;
+    static constexpr std::size_t tombstoneHash = 1;
+
+    struct Entry
+    {
+        std::size_t hash = emptyHash;
+        Object key;
+        Object value;
+
+        bool live() const { return hash > tombstoneHash; }
+    };
+
+    std::vector<Entry> entries;
+    std::size_t count = 0;
+    // live entries and tombstones.
+    std::size_t used = 0;
+
+    static std::size_t hash(const Object & key);
+    static bool sameKey(const Object & left, const Object & right);
+    // entry holding 'key', or the one it should be inserted in.
+    std::size_t slot(const Object & key, std::size_t hash) const;
+    void grow();
+};
+
+#endif //LOXPLUS_LOXMAP_H
@@ -0,0 +1,39 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "LoxNative.h"
+
+LoxNative::LoxNative(std::string name, int arity, Function function)
+    : name { std::move(name) }, argumentCount { arity }, function { function }
+{
+}
+
+Object LoxNative::call(Interpreter & interpreter, Arguments arguments)
+{
+    return function(interpreter, arguments);
+}
+
+int LoxNative::arity() const
+{
+    return argumentCount;
+}
+
+void LoxNative::trace(Tracer & tracer)
+{
+}
+
+std::size_t LoxNative::heapSize() const
+{
+    return sizeof(*this);
+}
+
+std::string LoxNative::describe() const
+{
+    return getName();
+}
+
+HeapObject* LoxNative::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
@@ -0,0 +1,48 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_LOXNATIVE_H
+#define LOXPLUS_LOXNATIVE_H
+
+#include <string>
+#include "LoxCallable.h"
+#include "HeapObject.h"
+
+/*
+ * Function implemented in C++. It is a plain function pointer called with
+ * the view over the arguments on the value stack, there is no environment
+ * nor frame. Report errors by throwing a NativeError, the interpreter
+ * turns it into a RuntimeError at the call site.
+ * */
+class LoxNative : public HeapObject, public CreatableType<LoxNative>, public LoxCallable
+{
+public:
+    using Function = Interpreter::NativeFunction;
+
+    LoxNative(std::string name, int arity, Function function);
+    Object call(Interpreter & interpreter, Arguments arguments) override;
+    int arity() const override;
+
+    LoxNative(const LoxNative &) = delete;
+    LoxNative(LoxNative &&) = default;
+
+    LoxNative & operator=(const LoxNative &) = delete;
+    LoxNative & operator=(LoxNative &&) = default;
+    ~LoxNative() override = default;
+
+    std::string getName() const override { return "<native " + name + ">"; }
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
+private:
+    std::string name;
+    int argumentCount;
+    Function function;
+};
+
+
+#endif //LOXPLUS_LOXNATIVE_H
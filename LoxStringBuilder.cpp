@@ -0,0 +1,24 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "LoxStringBuilder.h"
+
+void LoxStringBuilder::trace(Tracer & tracer)
+{
+}
+
+std::size_t LoxStringBuilder::heapSize() const
+{
+    return sizeof(*this) + buffer.capacity();
+}
+
+std::string LoxStringBuilder::describe() const
+{
+    return "StringBuilder [" + std::to_string(buffer.size()) + "]";
+}
+
+HeapObject* LoxStringBuilder::relocate(void* memory)
+{
+    return moveTo(*this, memory);
+}
@@ -0,0 +1,35 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_LOXSTRINGBUILDER_H
+#define LOXPLUS_LOXSTRINGBUILDER_H
+
+#include <string>
+#include "CreatableType.h"
+#include "HeapObject.h"
+
+/*
+ * Growable string for building one piece by piece. Appending to it is
+ * amortised O(1) where 's = s + piece' copies the whole of 's' every
+ * time. It holds no references, the collector never looks inside.
+ * */
+class LoxStringBuilder : public HeapObject, public CreatableType<LoxStringBuilder>
+{
+public:
+    LoxStringBuilder() = default;
+
+    std::size_t size() const { return buffer.size(); }
+    void append(const std::string & string) { buffer += string; }
+    const std::string & toString() const { return buffer; }
+
+    void trace(Tracer & tracer) override;
+    std::size_t heapSize() const override;
+    std::string describe() const override;
+    HeapObject* relocate(void* memory) override;
+
+private:
+    std::string buffer;
+};
+
+#endif //LOXPLUS_LOXSTRINGBUILDER_H
@@ -0,0 +1,19 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_NATIVEERROR_H
+#define LOXPLUS_NATIVEERROR_H
+
+
+#include <stdexcept>
+
+// thrown by natives, which do not know the token of the call.
+class NativeError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+
+#endif //LOXPLUS_NATIVEERROR_H
@@ -0,0 +1,606 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Natives.h"
+#include "AllocationProfiler.h"
+#include "HeapSnapshot.h"
+#include "Kernels.h"
+#include "LoxArray.h"
+#include "LoxFloat64Array.h"
+#include "LoxMap.h"
+#include "LoxStringBuilder.h"
+#include "LoxFile.h"
+#include "LoxFunction.h"
+#include "LoxGenerator.h"
+#include "NativeError.h"
+#include "Numbers.h"
+#include "Output.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+void Natives::define(Interpreter & interpreter)
+{
+    interpreter.defineNative("abs", 1, abs);
+    interpreter.defineNative("floor", 1, floor);
+    interpreter.defineNative("ceil", 1, ceil);
+    interpreter.defineNative("sqrt", 1, sqrt);
+    interpreter.defineNative("pow", 2, pow);
+    interpreter.defineNative("min", 2, min);
+    interpreter.defineNative("max", 2, max);
+
+    interpreter.defineNative("len", 1, len);
+    interpreter.defineNative("substring", 3, substring);
+    interpreter.defineNative("indexOf", 2, indexOf);
+    interpreter.defineNative("str", 1, str);
+    interpreter.defineNative("num", 1, num);
+    interpreter.defineNative("StringBuilder", 0, stringBuilder);
+    interpreter.defineNative("append", 2, append);
+    interpreter.defineNative("build", 1, build);
+
+    interpreter.defineNative("push", 2, push);
+    interpreter.defineNative("pop", 1, pop);
+
+    interpreter.defineNative("Float64Array", 1, float64Array);
+    interpreter.defineNative("sum", 1, sum);
+    interpreter.defineNative("dot", 2, dot);
+    interpreter.defineNative("minElement", 1, minElement);
+    interpreter.defineNative("maxElement", 1, maxElement);
+    interpreter.defineNative("scale", 2, scale);
+    interpreter.defineNative("axpy", 3, axpy);
+    interpreter.defineNative("addArrays", 3, elementwise<Kernels::add>);
+    interpreter.defineNative("subtractArrays", 3, elementwise<Kernels::subtract>);
+    interpreter.defineNative("multiplyArrays", 3, elementwise<Kernels::multiply>);
+    interpreter.defineNative("divideArrays", 3, elementwise<Kernels::divide>);
+
+    interpreter.defineNative("Map", 0, map);
+    interpreter.defineNative("get", 2, get);
+    interpreter.defineNative("set", 3, set);
+    interpreter.defineNative("has", 2, has);
+    interpreter.defineNative("delete", 2, remove);
+    interpreter.defineNative("keys", 1, keys);
+
+    interpreter.defineNative("openFile", 1, openFile);
+    interpreter.defineNative("readLine", 1, readLine);
+    interpreter.defineNative("findLine", 2, findLine);
+    interpreter.defineNative("closeFile", 1, closeFile);
+    interpreter.defineNative("readAll", 1, readAll);
+    interpreter.defineNative("writeAll", 2, writeAll);
+
+    interpreter.defineNative("next", 1, next);
+    interpreter.defineNative("done", 1, done);
+
+    interpreter.defineNative("clock", 0, clock);
+    interpreter.defineNative("nanotime", 0, nanotime);
+    interpreter.defineNative("bench", 2, bench);
+
+    interpreter.defineNative("allocationReport", 0, allocationReport);
+    interpreter.defineNative("heapSnapshot", 1, heapSnapshot);
+}
+
+double Natives::toNumber(const Object & value)
+{
+    if (!value.isDouble())
+    {
+        throw NativeError("Argument must be a number.");
+    }
+
+    return value.asDouble();
+}
+
+const std::string & Natives::toString(const Object & value)
+{
+    if (!value.isString())
+    {
+        throw NativeError("Argument must be a string.");
+    }
+
+    return value.asString();
+}
+
+LoxArray* Natives::toArray(const Object & value)
+{
+    if (!value.isArray())
+    {
+        throw NativeError("Argument must be an array.");
+    }
+
+    return value.asArray();
+}
+
+LoxFloat64Array* Natives::toFloat64Array(const Object & value)
+{
+    if (!value.isFloat64Array())
+    {
+        throw NativeError("Argument must be a Float64Array.");
+    }
+
+    return value.asFloat64Array();
+}
+
+LoxMap* Natives::toMap(const Object & value)
+{
+    if (!value.isMap())
+    {
+        throw NativeError("Argument must be a map.");
+    }
+
+    return value.asMap();
+}
+
+LoxStringBuilder* Natives::toStringBuilder(const Object & value)
+{
+    if (!value.isStringBuilder())
+    {
+        throw NativeError("Argument must be a StringBuilder.");
+    }
+
+    return value.asStringBuilder();
+}
+
+LoxFile* Natives::toFile(const Object & value)
+{
+    if (!value.isFile())
+    {
+        throw NativeError("Argument must be a file.");
+    }
+
+    return value.asFile();
+}
+
+LoxGenerator* Natives::toGenerator(const Object & value)
+{
+    if (!value.isGenerator())
+    {
+        throw NativeError("Argument must be a generator.");
+    }
+
+    return value.asGenerator();
+}
+
+const Object & Natives::toKey(const Object & value)
+{
+    if (!LoxMap::isValidKey(value))
+    {
+        throw NativeError("Map keys must be strings, numbers or booleans.");
+    }
+
+    return value;
+}
+
+std::size_t Natives::sameSize(std::initializer_list<LoxFloat64Array*> arrays)
+{
+    auto size = (*arrays.begin())->size();
+    for (auto array : arrays)
+    {
+        if (array->size() != size)
+        {
+            throw NativeError("Arrays must have the same length.");
+        }
+    }
+
+    return size;
+}
+
+Object Natives::abs(Interpreter & interpreter, Arguments arguments)
+{
+    return std::fabs(toNumber(arguments[0]));
+}
+
+Object Natives::floor(Interpreter & interpreter, Arguments arguments)
+{
+    return std::floor(toNumber(arguments[0]));
+}
+
+Object Natives::ceil(Interpreter & interpreter, Arguments arguments)
+{
+    return std::ceil(toNumber(arguments[0]));
+}
+
+Object Natives::sqrt(Interpreter & interpreter, Arguments arguments)
+{
+    return std::sqrt(toNumber(arguments[0]));
+}
+
+Object Natives::pow(Interpreter & interpreter, Arguments arguments)
+{
+    return std::pow(toNumber(arguments[0]), toNumber(arguments[1]));
+}
+
+Object Natives::min(Interpreter & interpreter, Arguments arguments)
+{
+    return std::min(toNumber(arguments[0]), toNumber(arguments[1]));
+}
+
+Object Natives::max(Interpreter & interpreter, Arguments arguments)
+{
+    return std::max(toNumber(arguments[0]), toNumber(arguments[1]));
+}
+
+Object Natives::len(Interpreter & interpreter, Arguments arguments)
+{
+    if (arguments[0].isArray())
+    {
+        return static_cast<double>(arguments[0].asArray()->size());
+    }
+    if (arguments[0].isFloat64Array())
+    {
+        return static_cast<double>(arguments[0].asFloat64Array()->size());
+    }
+    if (arguments[0].isMap())
+    {
+        return static_cast<double>(arguments[0].asMap()->size());
+    }
+    if (arguments[0].isStringBuilder())
+    {
+        return static_cast<double>(arguments[0].asStringBuilder()->size());
+    }
+
+    return static_cast<double>(toString(arguments[0]).size());
+}
+
+Object Natives::substring(Interpreter & interpreter, Arguments arguments)
+{
+    auto & string = toString(arguments[0]);
+    auto start = toNumber(arguments[1]);
+    auto end = toNumber(arguments[2]);
+
+    if (start < 0 || end < start || end > string.size() || start != std::floor(start) || end != std::floor(end))
+    {
+        throw NativeError("Substring bounds out of range.");
+    }
+
+    return string.substr(static_cast<std::size_t>(start), static_cast<std::size_t>(end - start));
+}
+
+Object Natives::indexOf(Interpreter & interpreter, Arguments arguments)
+{
+    auto position = toString(arguments[0]).find(toString(arguments[1]));
+    return position == std::string::npos ? -1.0 : static_cast<double>(position);
+}
+
+// str(value): the value as print shows it.
+Object Natives::str(Interpreter & interpreter, Arguments arguments)
+{
+    return to_string(arguments[0]);
+}
+
+// num(string): the number written in the whole string, nil when it is not one.
+Object Natives::num(Interpreter & interpreter, Arguments arguments)
+{
+    double number;
+    if (!Numbers::parse(toString(arguments[0]), number)) return Object {};
+
+    return number;
+}
+
+Object Natives::stringBuilder(Interpreter & interpreter, Arguments arguments)
+{
+    return LoxStringBuilder::create();
+}
+
+// append(builder, value): appends the string, or how 'value' is printed, and returns the builder.
+Object Natives::append(Interpreter & interpreter, Arguments arguments)
+{
+    auto builder = toStringBuilder(arguments[0]);
+    if (arguments[1].isString())
+    {
+        builder->append(arguments[1].asString());
+    }
+    else
+    {
+        builder->append(to_string(arguments[1]));
+    }
+
+    return builder;
+}
+
+// build(builder): the string appended so far, the builder can still be appended to.
+Object Natives::build(Interpreter & interpreter, Arguments arguments)
+{
+    return toStringBuilder(arguments[0])->toString();
+}
+
+Object Natives::push(Interpreter & interpreter, Arguments arguments)
+{
+    toArray(arguments[0])->push(arguments[1]);
+    return static_cast<double>(arguments[0].asArray()->size());
+}
+
+Object Natives::pop(Interpreter & interpreter, Arguments arguments)
+{
+    return toArray(arguments[0])->pop();
+}
+
+/*
+ * Float64Array(size) is filled with zeros, Float64Array(array) copies an
+ * array of numbers.
+ * */
+Object Natives::float64Array(Interpreter & interpreter, Arguments arguments)
+{
+    std::vector<double> elements;
+    if (arguments[0].isArray())
+    {
+        auto array = arguments[0].asArray();
+        elements.reserve(array->size());
+        for (std::size_t i = 0; i < array->size(); i++)
+        {
+            elements.push_back(toNumber(array->get(i)));
+        }
+    }
+    else
+    {
+        auto size = toNumber(arguments[0]);
+        if (size < 0 || size != std::floor(size))
+        {
+            throw NativeError("Float64Array() expects a size or an array of numbers.");
+        }
+        elements.resize(static_cast<std::size_t>(size));
+    }
+
+    return LoxFloat64Array::create(std::move(elements));
+}
+
+Object Natives::sum(Interpreter & interpreter, Arguments arguments)
+{
+    auto x = toFloat64Array(arguments[0]);
+    return Kernels::sum(x->data(), x->size());
+}
+
+Object Natives::dot(Interpreter & interpreter, Arguments arguments)
+{
+    auto x = toFloat64Array(arguments[0]);
+    auto y = toFloat64Array(arguments[1]);
+    return Kernels::dot(x->data(), y->data(), sameSize({ x, y }));
+}
+
+Object Natives::minElement(Interpreter & interpreter, Arguments arguments)
+{
+    auto x = toFloat64Array(arguments[0]);
+    if (x->size() == 0)
+    {
+        throw NativeError("minElement() of an empty array.");
+    }
+
+    return Kernels::min(x->data(), x->size());
+}
+
+Object Natives::maxElement(Interpreter & interpreter, Arguments arguments)
+{
+    auto x = toFloat64Array(arguments[0]);
+    if (x->size() == 0)
+    {
+        throw NativeError("maxElement() of an empty array.");
+    }
+
+    return Kernels::max(x->data(), x->size());
+}
+
+// scale(x, factor): multiplies x in place and returns it.
+Object Natives::scale(Interpreter & interpreter, Arguments arguments)
+{
+    auto x = toFloat64Array(arguments[0]);
+    Kernels::scale(x->data(), toNumber(arguments[1]), x->size());
+    return x;
+}
+
+// axpy(alpha, x, y): adds alpha * x to y in place and returns y.
+Object Natives::axpy(Interpreter & interpreter, Arguments arguments)
+{
+    auto alpha = toNumber(arguments[0]);
+    auto x = toFloat64Array(arguments[1]);
+    auto y = toFloat64Array(arguments[2]);
+    Kernels::axpy(alpha, x->data(), y->data(), sameSize({ x, y }));
+    return y;
+}
+
+// addArrays(out, x, y) and co: out = x <op> y, returns out.
+template <void (*kernel)(double*, const double*, const double*, std::size_t)>
+Object Natives::elementwise(Interpreter & interpreter, Arguments arguments)
+{
+    auto out = toFloat64Array(arguments[0]);
+    auto x = toFloat64Array(arguments[1]);
+    auto y = toFloat64Array(arguments[2]);
+    kernel(out->data(), x->data(), y->data(), sameSize({ out, x, y }));
+    return out;
+}
+
+Object Natives::map(Interpreter & interpreter, Arguments arguments)
+{
+    return LoxMap::create();
+}
+
+// get(map, key): nil when the key is absent.
+Object Natives::get(Interpreter & interpreter, Arguments arguments)
+{
+    auto value = toMap(arguments[0])->find(toKey(arguments[1]));
+    return value != nullptr ? *value : Object {};
+}
+
+// set(map, key, value): returns the value.
+Object Natives::set(Interpreter & interpreter, Arguments arguments)
+{
+    toMap(arguments[0])->set(toKey(arguments[1]), arguments[2]);
+    return arguments[2];
+}
+
+Object Natives::has(Interpreter & interpreter, Arguments arguments)
+{
+    return toMap(arguments[0])->find(toKey(arguments[1])) != nullptr;
+}
+
+// delete(map, key): whether the key was present.
+Object Natives::remove(Interpreter & interpreter, Arguments arguments)
+{
+    return toMap(arguments[0])->remove(toKey(arguments[1]));
+}
+
+// keys(map): an array of the keys, in no particular order.
+Object Natives::keys(Interpreter & interpreter, Arguments arguments)
+{
+    return LoxArray::create(toMap(arguments[0])->keys());
+}
+
+Object Natives::openFile(Interpreter & interpreter, Arguments arguments)
+{
+    auto & path = toString(arguments[0]);
+    auto file = LoxFile::open(path);
+    if (file == nullptr)
+    {
+        throw NativeError("Cannot open file '" + path + "'.");
+    }
+
+    return file;
+}
+
+// readLine(file): the next line without its line break, nil after the last one.
+Object Natives::readLine(Interpreter & interpreter, Arguments arguments)
+{
+    auto line = toFile(arguments[0])->nextLine();
+    return line ? Object { std::string { *line } } : Object {};
+}
+
+// findLine(file, text): the next line containing 'text', nil when there is none.
+Object Natives::findLine(Interpreter & interpreter, Arguments arguments)
+{
+    auto file = toFile(arguments[0]);
+    auto line = file->findLine(toString(arguments[1]));
+    return line ? Object { std::string { *line } } : Object {};
+}
+
+Object Natives::closeFile(Interpreter & interpreter, Arguments arguments)
+{
+    toFile(arguments[0])->close();
+    return Object {};
+}
+
+Object Natives::readAll(Interpreter & interpreter, Arguments arguments)
+{
+    auto & path = toString(arguments[0]);
+    std::string content;
+    if (!LoxFile::readAll(path, content))
+    {
+        throw NativeError("Cannot read file '" + path + "'.");
+    }
+
+    return Object { std::move(content) };
+}
+
+// writeAll(path, string): replaces the file with the string, returns its length.
+Object Natives::writeAll(Interpreter & interpreter, Arguments arguments)
+{
+    auto & path = toString(arguments[0]);
+    auto & content = toString(arguments[1]);
+    if (!LoxFile::writeAll(path, content))
+    {
+        throw NativeError("Cannot write file '" + path + "'.");
+    }
+
+    return static_cast<double>(content.size());
+}
+
+// next(generator): runs it until its next yield and returns the value, nil once it is done.
+Object Natives::next(Interpreter & interpreter, Arguments arguments)
+{
+    return toGenerator(arguments[0])->resume(interpreter);
+}
+
+Object Natives::done(Interpreter & interpreter, Arguments arguments)
+{
+    return toGenerator(arguments[0])->done();
+}
+
+Object Natives::clock(Interpreter & interpreter, Arguments arguments)
+{
+    using seconds = std::chrono::duration<double>;
+    return std::chrono::duration_cast<seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Object Natives::nanotime(Interpreter & interpreter, Arguments arguments)
+{
+    using nanoseconds = std::chrono::duration<double, std::nano>;
+    return std::chrono::duration_cast<nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * bench(fn, iterations): calls 'fn' a tenth of 'iterations' times to warm
+ * the caches up, then times each of the 'iterations' calls on its own.
+ * Prints the min, median and 99th percentile and returns the median, in
+ * nanoseconds per call, with the cost of reading the clock removed.
+ * */
+Object Natives::bench(Interpreter & interpreter, Arguments arguments)
+{
+    using clock = std::chrono::steady_clock;
+
+    if (!arguments[0].isCallable() || arguments[0].asCallable()->arity() != 0)
+    {
+        throw NativeError("bench() expects a function taking no arguments.");
+    }
+    auto iterations = toNumber(arguments[1]);
+    if (iterations < 1 || iterations != std::floor(iterations))
+    {
+        throw NativeError("bench() expects a positive number of iterations.");
+    }
+
+    // the arguments do not survive calling back into Lox.
+    auto function = arguments[0].asCallable();
+    auto name = arguments[0].isFunction() ? arguments[0].asFunction()->getDeclaration()->name.lexeme : function->getName();
+    auto count = static_cast<std::size_t>(iterations);
+
+    for (std::size_t i = 0; i < std::max<std::size_t>(count / 10, 1); i++)
+    {
+        function->call(interpreter, Arguments { nullptr, 0 });
+    }
+
+    auto overhead = clock::duration::max();
+    for (int i = 0; i < 100; i++)
+    {
+        auto start = clock::now();
+        overhead = std::min(overhead, clock::now() - start);
+    }
+
+    std::vector<double> samples(count);
+    for (auto & sample : samples)
+    {
+        auto start = clock::now();
+        function->call(interpreter, Arguments { nullptr, 0 });
+        auto elapsed = clock::now() - start - overhead;
+        sample = std::chrono::duration<double, std::nano>(std::max(elapsed, clock::duration::zero())).count();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto median = samples[count / 2];
+    auto p99 = samples[std::min(count - 1, count * 99 / 100)];
+
+    Output::line("bench " + name + ": min " + Numbers::format(samples.front()) + " ns, median " + Numbers::format(median)
+                 + " ns, p99 " + Numbers::format(p99) + " ns (" + std::to_string(count) + " iterations)");
+
+    return median;
+}
+
+Object Natives::allocationReport(Interpreter & interpreter, Arguments arguments)
+{
+    if (!AllocationProfiler::enabled)
+    {
+        throw NativeError("allocationReport() needs --alloc-profile.");
+    }
+
+    Output::flush();
+    AllocationProfiler::report(std::cerr, 20);
+    return Object();
+}
+
+Object Natives::heapSnapshot(Interpreter & interpreter, Arguments arguments)
+{
+    auto & path = toString(arguments[0]);
+    auto nodes = HeapSnapshot::write(interpreter, path);
+    if (nodes == 0)
+    {
+        throw NativeError("Cannot write heap snapshot to '" + path + "'.");
+    }
+
+    return static_cast<double>(nodes);
+}
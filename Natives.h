@@ -0,0 +1,97 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_NATIVES_H
+#define LOXPLUS_NATIVES_H
+
+#include <initializer_list>
+#include "Interpreter.h"
+
+// standard library, defined as globals of every interpreter.
+class Natives
+{
+public:
+    Natives() = delete;
+
+    static void define(Interpreter & interpreter);
+
+private:
+    static double toNumber(const Object & value);
+    static const std::string & toString(const Object & value);
+    static LoxArray* toArray(const Object & value);
+    static LoxFloat64Array* toFloat64Array(const Object & value);
+    static LoxMap* toMap(const Object & value);
+    static LoxStringBuilder* toStringBuilder(const Object & value);
+    static LoxFile* toFile(const Object & value);
+    static LoxGenerator* toGenerator(const Object & value);
+    static const Object & toKey(const Object & value);
+    // the common size of the arrays, which must all have the same.
+    static std::size_t sameSize(std::initializer_list<LoxFloat64Array*> arrays);
+
+    // math
+    static Object abs(Interpreter & interpreter, Arguments arguments);
+    static Object floor(Interpreter & interpreter, Arguments arguments);
+    static Object ceil(Interpreter & interpreter, Arguments arguments);
+    static Object sqrt(Interpreter & interpreter, Arguments arguments);
+    static Object pow(Interpreter & interpreter, Arguments arguments);
+    static Object min(Interpreter & interpreter, Arguments arguments);
+    static Object max(Interpreter & interpreter, Arguments arguments);
+
+    // strings
+    static Object len(Interpreter & interpreter, Arguments arguments);
+    static Object substring(Interpreter & interpreter, Arguments arguments);
+    static Object indexOf(Interpreter & interpreter, Arguments arguments);
+    static Object str(Interpreter & interpreter, Arguments arguments);
+    static Object num(Interpreter & interpreter, Arguments arguments);
+    static Object stringBuilder(Interpreter & interpreter, Arguments arguments);
+    static Object append(Interpreter & interpreter, Arguments arguments);
+    static Object build(Interpreter & interpreter, Arguments arguments);
+
+    // arrays
+    static Object push(Interpreter & interpreter, Arguments arguments);
+    static Object pop(Interpreter & interpreter, Arguments arguments);
+
+    // Float64Array, the loops run in Kernels
+    static Object float64Array(Interpreter & interpreter, Arguments arguments);
+    static Object sum(Interpreter & interpreter, Arguments arguments);
+    static Object dot(Interpreter & interpreter, Arguments arguments);
+    static Object minElement(Interpreter & interpreter, Arguments arguments);
+    static Object maxElement(Interpreter & interpreter, Arguments arguments);
+    static Object scale(Interpreter & interpreter, Arguments arguments);
+    static Object axpy(Interpreter & interpreter, Arguments arguments);
+    template <void (*kernel)(double*, const double*, const double*, std::size_t)>
+    static Object elementwise(Interpreter & interpreter, Arguments arguments);
+
+    // maps
+    static Object map(Interpreter & interpreter, Arguments arguments);
+    static Object get(Interpreter & interpreter, Arguments arguments);
+    static Object set(Interpreter & interpreter, Arguments arguments);
+    static Object has(Interpreter & interpreter, Arguments arguments);
+    static Object remove(Interpreter & interpreter, Arguments arguments);
+    static Object keys(Interpreter & interpreter, Arguments arguments);
+
+    // files
+    static Object openFile(Interpreter & interpreter, Arguments arguments);
+    static Object readLine(Interpreter & interpreter, Arguments arguments);
+    static Object findLine(Interpreter & interpreter, Arguments arguments);
+    static Object closeFile(Interpreter & interpreter, Arguments arguments);
+    static Object readAll(Interpreter & interpreter, Arguments arguments);
+    static Object writeAll(Interpreter & interpreter, Arguments arguments);
+
+    // generators
+    static Object next(Interpreter & interpreter, Arguments arguments);
+    static Object done(Interpreter & interpreter, Arguments arguments);
+
+    // time
+    static Object clock(Interpreter & interpreter, Arguments arguments);
+    static Object nanotime(Interpreter & interpreter, Arguments arguments);
+    static Object bench(Interpreter & interpreter, Arguments arguments);
+
+    // diagnostics
+    static Object allocationReport(Interpreter & interpreter, Arguments arguments);
+    static Object heapSnapshot(Interpreter & interpreter, Arguments arguments);
+};
+
+
+#endif //LOXPLUS_NATIVES_H
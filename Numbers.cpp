@@ -0,0 +1,33 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Numbers.h"
+#include <charconv>
+#include <cmath>
+
+std::string Numbers::format(double number)
+{
+    // 0 / 0 has its sign bit set on x86, all NaNs print the same.
+    if (std::isnan(number)) return "nan";
+
+    // the longest shortest form is "-2.2250738585072014e-308".
+    char buffer[32];
+    auto end = buffer + sizeof(buffer);
+
+    // counters and sizes keep all their digits, as long as every integer up to them is exact.
+    auto integral = std::trunc(number) == number && std::fabs(number) < 9007199254740992.0;
+    auto result = integral ? std::to_chars(buffer, end, number, std::chars_format::fixed) : std::to_chars(buffer, end, number);
+    return std::string(buffer, result.ptr);
+}
+
+bool Numbers::parse(std::string_view text, double & number)
+{
+    double value;
+    auto end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    if (result.ec != std::errc {} || result.ptr != end) return false;
+
+    number = value;
+    return true;
+}
@@ -0,0 +1,28 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_NUMBERS_H
+#define LOXPLUS_NUMBERS_H
+
+#include <string>
+#include <string_view>
+
+/*
+ * Conversions between numbers and their text, with std::to_chars and
+ * std::from_chars: they ignore the locale and do not allocate. Numbers
+ * are written with the fewest digits that read back as the same double,
+ * so 1 prints as "1" and 0.1 as "0.1", but the integers below 2^53 are
+ * written in full: 100000 prints as "100000", not "1e+05".
+ * */
+class Numbers
+{
+public:
+    Numbers() = delete;
+
+    static std::string format(double number);
+    // false, leaving 'number' untouched, unless all of 'text' is a number.
+    static bool parse(std::string_view text, double & number);
+};
+
+#endif //LOXPLUS_NUMBERS_H
@@ -5,6 +5,16 @@
 #include "LoxCallable.h"
 #include "LoxInstance.h"
 #include "LoxFunction.h"
+#include "LoxNative.h"
+#include "LoxArray.h"
+#include "LoxFloat64Array.h"
+#include "LoxMap.h"
+#include "LoxStringBuilder.h"
+#include "LoxFile.h"
+#include "LoxGenerator.h"
+#include "LoxClass.h"
+#include "HeapObject.h"
+#include "Numbers.h"
 
 Object::Object()
     : Object(nullptr)
@@ -32,7 +42,7 @@ Object::Object(std::nullptr_t)
 }
 
 Object::Object(std::string string)
-    : data { string }
+    : data { std::move(string) }
 {
 }
 
@@ -51,6 +61,41 @@ Object::Object(LoxInstance* instance)
 {
 }
 
+Object::Object(LoxNative* native)
+    : data { native }
+{
+}
+
+Object::Object(LoxArray* array)
+    : data { array }
+{
+}
+
+Object::Object(LoxFloat64Array* array)
+    : data { array }
+{
+}
+
+Object::Object(LoxMap* map)
+    : data { map }
+{
+}
+
+Object::Object(LoxStringBuilder* builder)
+    : data { builder }
+{
+}
+
+Object::Object(LoxFile* file)
+    : data { file }
+{
+}
+
+Object::Object(LoxGenerator* generator)
+    : data { generator }
+{
+}
+
 bool Object::isDouble() const
 {
     return std::holds_alternative<double>(data);
@@ -73,7 +118,7 @@ bool Object::isBool() const
 
 bool Object::isCallable() const
 {
-    return isFunction() || isClass();
+    return isFunction() || isClass() || isNative();
 }
 
 bool Object::isInstance() const
@@ -91,6 +136,41 @@ bool Object::isClass() const
     return std::holds_alternative<LoxClass*>(data);
 }
 
+bool Object::isNative() const
+{
+    return std::holds_alternative<LoxNative*>(data);
+}
+
+bool Object::isArray() const
+{
+    return std::holds_alternative<LoxArray*>(data);
+}
+
+bool Object::isFloat64Array() const
+{
+    return std::holds_alternative<LoxFloat64Array*>(data);
+}
+
+bool Object::isMap() const
+{
+    return std::holds_alternative<LoxMap*>(data);
+}
+
+bool Object::isStringBuilder() const
+{
+    return std::holds_alternative<LoxStringBuilder*>(data);
+}
+
+bool Object::isFile() const
+{
+    return std::holds_alternative<LoxFile*>(data);
+}
+
+bool Object::isGenerator() const
+{
+    return std::holds_alternative<LoxGenerator*>(data);
+}
+
 int Object::index() const
 {
     return data.index();
@@ -106,7 +186,7 @@ bool Object::asBool() const
     return std::get<bool>(data);
 }
 
-std::string Object::asString() const
+const std::string & Object::asString() const
 {
     return std::get<std::string>(data);
 }
@@ -121,24 +201,142 @@ LoxCallable* Object::asCallable() const
     {
         return std::get<LoxClass*>(data);
     }
+    else if (isNative())
+    {
+        return std::get<LoxNative*>(data);
+    }
     else
     {
         throw "Not a callable object";
     }
 }
 
+LoxFunction* Object::asFunction() const
+{
+    return std::get<LoxFunction*>(data);
+}
+
+LoxClass* Object::asClass() const
+{
+    return std::get<LoxClass*>(data);
+}
+
 LoxInstance* Object::asInstance() const
 {
     return std::get<LoxInstance*>(data);
 }
 
+LoxNative* Object::asNative() const
+{
+    return std::get<LoxNative*>(data);
+}
+
+LoxArray* Object::asArray() const
+{
+    return std::get<LoxArray*>(data);
+}
+
+LoxFloat64Array* Object::asFloat64Array() const
+{
+    return std::get<LoxFloat64Array*>(data);
+}
+
+LoxMap* Object::asMap() const
+{
+    return std::get<LoxMap*>(data);
+}
+
+LoxStringBuilder* Object::asStringBuilder() const
+{
+    return std::get<LoxStringBuilder*>(data);
+}
+
+LoxFile* Object::asFile() const
+{
+    return std::get<LoxFile*>(data);
+}
+
+LoxGenerator* Object::asGenerator() const
+{
+    return std::get<LoxGenerator*>(data);
+}
+
+void Object::trace(Tracer & tracer)
+{
+    if (auto function = std::get_if<LoxFunction*>(&data))
+    {
+        tracer.trace(*function);
+    }
+    else if (auto klass = std::get_if<LoxClass*>(&data))
+    {
+        tracer.trace(*klass);
+    }
+    else if (auto instance = std::get_if<LoxInstance*>(&data))
+    {
+        tracer.trace(*instance);
+    }
+    else if (auto native = std::get_if<LoxNative*>(&data))
+    {
+        tracer.trace(*native);
+    }
+    else if (auto array = std::get_if<LoxArray*>(&data))
+    {
+        tracer.trace(*array);
+    }
+    else if (auto array = std::get_if<LoxFloat64Array*>(&data))
+    {
+        tracer.trace(*array);
+    }
+    else if (auto map = std::get_if<LoxMap*>(&data))
+    {
+        tracer.trace(*map);
+    }
+    else if (auto builder = std::get_if<LoxStringBuilder*>(&data))
+    {
+        tracer.trace(*builder);
+    }
+    else if (auto file = std::get_if<LoxFile*>(&data))
+    {
+        tracer.trace(*file);
+    }
+    else if (auto generator = std::get_if<LoxGenerator*>(&data))
+    {
+        tracer.trace(*generator);
+    }
+    else if (auto string = std::get_if<std::string>(&data))
+    {
+        tracer.visitString(*string);
+    }
+}
+
+HeapObject* Object::heapObject() const
+{
+    if (auto function = std::get_if<LoxFunction*>(&data)) return *function;
+    if (auto klass = std::get_if<LoxClass*>(&data)) return *klass;
+    if (auto instance = std::get_if<LoxInstance*>(&data)) return *instance;
+    if (auto native = std::get_if<LoxNative*>(&data)) return *native;
+    if (auto array = std::get_if<LoxArray*>(&data)) return *array;
+    if (auto array = std::get_if<LoxFloat64Array*>(&data)) return *array;
+    if (auto map = std::get_if<LoxMap*>(&data)) return *map;
+    if (auto builder = std::get_if<LoxStringBuilder*>(&data)) return *builder;
+    if (auto file = std::get_if<LoxFile*>(&data)) return *file;
+    if (auto generator = std::get_if<LoxGenerator*>(&data)) return *generator;
+
+    return nullptr;
+}
+
+void Tracer::trace(Object & value)
+{
+    value.trace(*this);
+}
+
 std::string to_string(const Object & object)
 {
     std::string ret;
 
     if (object.isDouble())
     {
-        ret = std::to_string(object.asDouble());
+        ret = Numbers::format(object.asDouble());
     }
     else if (object.isCallable())
     {
@@ -160,6 +358,30 @@ std::string to_string(const Object & object)
     {
         ret = to_string(object.asInstance()->getClass()) + " instance";
     }
+    else if (object.isArray())
+    {
+        ret = object.asArray()->toString();
+    }
+    else if (object.isFloat64Array())
+    {
+        ret = object.asFloat64Array()->toString();
+    }
+    else if (object.isMap())
+    {
+        ret = object.asMap()->toString();
+    }
+    else if (object.isStringBuilder())
+    {
+        ret = object.asStringBuilder()->toString();
+    }
+    else if (object.isFile())
+    {
+        ret = "<file " + object.asFile()->getPath() + ">";
+    }
+    else if (object.isGenerator())
+    {
+        ret = "<generator>";
+    }
     else
     {
         ret = "Unknown index: " + std::to_string(object.index());
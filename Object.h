@@ -12,11 +12,20 @@
 class LoxFunction;
 class LoxClass;
 class LoxInstance;
+class LoxNative;
+class LoxArray;
+class LoxFloat64Array;
+class LoxMap;
+class LoxStringBuilder;
+class LoxFile;
+class LoxGenerator;
 class LoxCallable;
+class Tracer;
+class HeapObject;
 
 class Object
 {
-    using ObjectVar = std::variant<std::nullptr_t, std::string, double, bool, LoxFunction*, LoxClass*, LoxInstance*>;
+    using ObjectVar = std::variant<std::nullptr_t, std::string, double, bool, LoxFunction*, LoxClass*, LoxInstance*, LoxNative*, LoxArray*, LoxFloat64Array*, LoxMap*, LoxStringBuilder*, LoxFile*, LoxGenerator*>;
 
 public:
     Object();
@@ -28,6 +37,13 @@ public:
     Object(LoxFunction* function);
     Object(LoxClass* klass);
     Object(LoxInstance* instance);
+    Object(LoxNative* native);
+    Object(LoxArray* array);
+    Object(LoxFloat64Array* array);
+    Object(LoxMap* map);
+    Object(LoxStringBuilder* builder);
+    Object(LoxFile* file);
+    Object(LoxGenerator* generator);
 
     template <typename T>
     Object(T*) = delete;
@@ -48,14 +64,35 @@ public:
     bool isInstance() const;
     bool isFunction() const;
     bool isClass() const;
+    bool isNative() const;
+    bool isArray() const;
+    bool isFloat64Array() const;
+    bool isMap() const;
+    bool isStringBuilder() const;
+    bool isFile() const;
+    bool isGenerator() const;
 
     int index() const;
 
     double asDouble() const;
     bool asBool() const;
-    std::string asString() const;
+    const std::string & asString() const;
     LoxCallable* asCallable() const;
+    LoxFunction* asFunction() const;
+    LoxClass* asClass() const;
     LoxInstance* asInstance() const;
+    LoxNative* asNative() const;
+    LoxArray* asArray() const;
+    LoxFloat64Array* asFloat64Array() const;
+    LoxMap* asMap() const;
+    LoxStringBuilder* asStringBuilder() const;
+    LoxFile* asFile() const;
+    LoxGenerator* asGenerator() const;
+
+    // lets 'tracer' visit, and update, the heap object held.
+    void trace(Tracer & tracer);
+    // the heap object held, nullptr for the other values.
+    HeapObject* heapObject() const;
 
 private:
     ObjectVar data;
@@ -0,0 +1,69 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Output.h"
+#include <cerrno>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+    std::string buffer;
+    std::size_t capacity = 64 * 1024;
+    bool lineFlushing = false;
+
+    void writeAll(std::string_view text)
+    {
+        while (!text.empty())
+        {
+            auto written = ::write(STDOUT_FILENO, text.data(), text.size());
+            if (written < 0)
+            {
+                if (errno == EINTR) continue;
+                // nowhere to report it, the output is lost like with a closed std::cout.
+                return;
+            }
+            text.remove_prefix(static_cast<std::size_t>(written));
+        }
+    }
+}
+
+void Output::configure(std::size_t bufferSize, bool flushLines)
+{
+    flush();
+    capacity = bufferSize;
+    lineFlushing = flushLines;
+    buffer.reserve(capacity);
+}
+
+bool Output::terminal()
+{
+    return isatty(STDOUT_FILENO) == 1;
+}
+
+void Output::write(std::string_view text)
+{
+    if (buffer.size() + text.size() > capacity)
+    {
+        flush();
+        // too large to be buffered, skip the copy.
+        if (text.size() > capacity) return writeAll(text);
+    }
+
+    buffer.append(text);
+}
+
+void Output::line(std::string_view text)
+{
+    write(text);
+    write("\n");
+
+    if (lineFlushing) flush();
+}
+
+void Output::flush()
+{
+    writeAll(buffer);
+    buffer.clear();
+}
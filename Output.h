@@ -0,0 +1,34 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_OUTPUT_H
+#define LOXPLUS_OUTPUT_H
+
+#include <cstddef>
+#include <string_view>
+
+/*
+ * Standard output of the scripts: print and the error reports. The text
+ * is gathered in a buffer written with write(2) when it would overflow,
+ * on flush(), and after each line when lines are flushed, bypassing
+ * iostream and its locale. Anything else writing to stdout or stderr
+ * must flush() first to keep the order.
+ * */
+class Output
+{
+public:
+    Output() = delete;
+
+    // flushes what is buffered, a size of 0 writes everything at once.
+    static void configure(std::size_t bufferSize, bool flushLines);
+    // whether stdout is a terminal, where lines are flushed by default.
+    static bool terminal();
+
+    static void write(std::string_view text);
+    // 'text' followed by a newline.
+    static void line(std::string_view text);
+    static void flush();
+};
+
+#endif //LOXPLUS_OUTPUT_H
@@ -164,6 +164,21 @@ Expr* Parser::primary()
         return GroupingExpr::create(std::move(expr));
     }
 
+    if (match(TokenType::LEFT_BRACKET))
+    {
+        auto bracket = previous();
+        std::vector<Expr*> elements;
+        if (!check(TokenType::RIGHT_BRACKET))
+        {
+            do
+            {
+                elements.push_back(expression());
+            } while (match(TokenType::COMMA));
+        }
+        consume(TokenType::RIGHT_BRACKET, "Expect ']' after array elements.");
+        return ArrayExpr::create(bracket, elements);
+    }
+
     error(peek(), "Expect expression.");
 }
 
@@ -198,6 +213,7 @@ void Parser::synchronize()
             case TokenType::WHILE:
             case TokenType::PRINT:
             case TokenType::RETURN:
+            case TokenType::YIELD:
                 return;
             default:
                 break;
@@ -228,15 +244,21 @@ std::vector<Stmt*> Parser::parse()
 
 Stmt* Parser::statement()
 {
-    if (match(TokenType::FUN)) return function("function");
-    if (match(TokenType::IF)) return ifStatement();
-    if (match(TokenType::WHILE)) return whileStatement();
-    if (match(TokenType::FOR)) return forStatement();
-    if (match(TokenType::PRINT)) return printStatement();
-    if (match(TokenType::RETURN)) return returnStatement();
-    if (match(TokenType::LEFT_BRACE)) return BlockStmt::create(block());
+    auto line = peek().line;
+    Stmt* stmt;
 
-    return expressionStatement();
+    if (match(TokenType::FUN)) stmt = function("function");
+    else if (match(TokenType::IF)) stmt = ifStatement();
+    else if (match(TokenType::WHILE)) stmt = whileStatement();
+    else if (match(TokenType::FOR)) stmt = forStatement();
+    else if (match(TokenType::PRINT)) stmt = printStatement();
+    else if (match(TokenType::RETURN)) stmt = returnStatement();
+    else if (match(TokenType::YIELD)) stmt = yieldStatement();
+    else if (match(TokenType::LEFT_BRACE)) stmt = BlockStmt::create(block());
+    else stmt = expressionStatement();
+
+    stmt->line = line;
+    return stmt;
 }
 
 Stmt* Parser::printStatement()
@@ -257,8 +279,9 @@ Stmt* Parser::declaration()
 {
     try
     {
-        if (match(TokenType::CLASS)) return classDeclaration();
-        if (match(TokenType::VAR)) return varDeclaration();
+        auto line = peek().line;
+        if (match(TokenType::CLASS)) return at(line, classDeclaration());
+        if (match(TokenType::VAR)) return at(line, varDeclaration());
 
         return statement();
     }
@@ -273,7 +296,7 @@ Stmt* Parser::varDeclaration()
 {
     auto name = consume(TokenType::IDENTIFIER, "Expect variable name.");
 
-    Expr* initializer;
+    Expr* initializer = nullptr;
     if (match(TokenType::EQUAL))
     {
         initializer = expression();
@@ -300,6 +323,10 @@ Expr* Parser::assignment()
         {
             return SetExpr::create(getExpr->object, getExpr->name, value);
         }
+        else if (auto* indexExpr = dynamic_cast<IndexExpr*>(expr); indexExpr != nullptr)
+        {
+            return IndexSetExpr::create(indexExpr->object, indexExpr->bracket, indexExpr->index, value);
+        }
 
         error(equals, "Invalid assignment target.");
     }
@@ -376,6 +403,7 @@ Stmt* Parser::whileStatement()
 
 Stmt* Parser::forStatement()
 {
+    auto keyword = previous();
     consume(TokenType::LEFT_PAREN, "Expect '(' after 'for'.");
 
     Stmt* initializer = nullptr;
@@ -385,11 +413,11 @@ Stmt* Parser::forStatement()
     }
     else if (match(TokenType::VAR))
     {
-        initializer = varDeclaration();
+        initializer = at(keyword.line, varDeclaration());
     }
     else
     {
-        initializer = expressionStatement();
+        initializer = at(keyword.line, expressionStatement());
     }
 
     Expr* condition = nullptr;
@@ -408,26 +436,7 @@ Stmt* Parser::forStatement()
 
     Stmt* body = statement();
 
-    if (increment != nullptr)
-    {
-        std::vector<Stmt*> newBody;
-        newBody.push_back(body);
-        newBody.push_back(ExpressionStmt::create(increment));
-        body = BlockStmt::create(newBody);
-    }
-
-    if (condition == nullptr) condition = LiteralExpr::create(true);
-    body = WhileStmt::create(condition, body);
-
-    if (initializer != nullptr)
-    {
-        std::vector<Stmt*> newBody;
-        newBody.push_back(initializer);
-        newBody.push_back(body);
-        body = BlockStmt::create(newBody);
-    }
-
-    return body;
+    return ForStmt::create(keyword, initializer, condition, increment, body);
 }
 
 Expr* Parser::call()
@@ -445,6 +454,13 @@ Expr* Parser::call()
             Token name = consume(TokenType::IDENTIFIER, "Expect property name after '.'.");
             expr = GetExpr::create(expr, name);
         }
+        else if (match(TokenType::LEFT_BRACKET))
+        {
+            auto bracket = previous();
+            auto index = expression();
+            consume(TokenType::RIGHT_BRACKET, "Expect ']' after index.");
+            expr = IndexExpr::create(expr, bracket, index);
+        }
         else
         {
             break;
@@ -496,7 +512,7 @@ FunctionStmt* Parser::function(std::string kind)
 
     consume(TokenType::LEFT_BRACE, "Expect '{' before " + kind + " body.");
     auto body = block();
-    return FunctionStmt::create(name, parameters, body);
+    return at(name.line, FunctionStmt::create(name, parameters, body));
 }
 
 Stmt* Parser::returnStatement()
@@ -512,6 +528,19 @@ Stmt* Parser::returnStatement()
     return ReturnStmt::create(keyword, value);
 }
 
+Stmt* Parser::yieldStatement()
+{
+    auto keyword = previous();
+    Expr* value = nullptr;
+    if (!check(TokenType::SEMICOLON))
+    {
+        value = expression();
+    }
+
+    consume(TokenType::SEMICOLON, "Expect ';' after yield value.");
+    return YieldStmt::create(keyword, value);
+}
+
 Stmt* Parser::classDeclaration()
 {
     Token name = consume(TokenType::IDENTIFIER, "Expect class name.");
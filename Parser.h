@@ -40,6 +40,7 @@ private:
     Stmt* returnStatement();
     Stmt* varDeclaration();
     Stmt* whileStatement();
+    Stmt* yieldStatement();
 
     std::vector<Stmt*> block();
 
@@ -63,6 +64,14 @@ private:
     Expr* finishCall(Expr* callee);
     FunctionStmt* function(std::string kind);
 
+    // records the line the statement starts at.
+    template <typename T>
+    T* at(std::size_t line, T* stmt)
+    {
+        stmt->line = line;
+        return stmt;
+    }
+
 };
 
 #endif //LOXPLUS_PARSER_H
@@ -0,0 +1,128 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Profiler.h"
+#include "LoxFunction.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sys/time.h>
+
+namespace
+{
+    struct Samples
+    {
+        std::size_t self = 0;
+        std::size_t total = 0;
+    };
+
+    std::map<std::string, std::size_t> stacks;
+    std::map<std::string, Samples> functions;
+    std::map<std::string, Samples> lines;
+    std::size_t samples = 0;
+
+    struct sigaction previousAction;
+
+    void onTimer(int)
+    {
+        Profiler::pending = 1;
+    }
+
+    std::string functionName(const Interpreter::CallFrame* frame)
+    {
+        return frame == nullptr ? "<script>" : frame->function->getDeclaration()->name.lexeme;
+    }
+
+    void printTable(std::ostream & out, const char* title, const std::map<std::string, Samples> & entries, std::size_t top)
+    {
+        std::vector<std::pair<std::string, Samples>> sorted { entries.begin(), entries.end() };
+        std::sort(sorted.begin(), sorted.end(), [](const auto & a, const auto & b) {
+            return a.second.self != b.second.self ? a.second.self > b.second.self : a.second.total > b.second.total;
+        });
+        if (sorted.size() > top) sorted.resize(top);
+
+        out << std::right << std::setw(8) << "self" << std::setw(8) << "self%" << std::setw(8) << "total" << std::setw(8) << "total%" << "  " << title << '\n';
+        for (auto & [name, count] : sorted)
+        {
+            out << std::setw(8) << count.self << std::setw(8) << 100.0 * count.self / samples
+                << std::setw(8) << count.total << std::setw(8) << 100.0 * count.total / samples
+                << "  " << name << '\n';
+        }
+    }
+}
+
+bool Profiler::start(long intervalMicroseconds)
+{
+    struct sigaction action {};
+    action.sa_handler = onTimer;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &previousAction) != 0) return false;
+
+    itimerval timer {};
+    timer.it_interval.tv_sec = intervalMicroseconds / 1000000;
+    timer.it_interval.tv_usec = intervalMicroseconds % 1000000;
+    timer.it_value = timer.it_interval;
+    return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+void Profiler::stop()
+{
+    itimerval timer {};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    sigaction(SIGPROF, &previousAction, nullptr);
+    pending = 0;
+}
+
+void Profiler::record(const std::vector<Interpreter::CallFrame> & frames, std::size_t line)
+{
+    pending = 0;
+    samples++;
+
+    // each frame is executing the line its callee was called from, the innermost one 'line'.
+    std::string stack;
+    std::set<std::string> seenFunctions, seenLines;
+    for (std::size_t i = 0; i <= frames.size(); i++)
+    {
+        auto name = functionName(i == 0 ? nullptr : &frames[i - 1]);
+        auto location = name + ":" + std::to_string(i < frames.size() ? frames[i].line : line);
+
+        if (i > 0) stack += ';';
+        stack += location;
+
+        if (seenFunctions.insert(name).second) functions[name].total++;
+        if (seenLines.insert(location).second) lines[location].total++;
+
+        if (i == frames.size())
+        {
+            functions[name].self++;
+            lines[location].self++;
+        }
+    }
+
+    stacks[stack]++;
+}
+
+void Profiler::report(std::ostream & collapsed, std::ostream & table, std::size_t top)
+{
+    for (auto & [stack, count] : stacks)
+    {
+        collapsed << stack << ' ' << count << '\n';
+    }
+
+    if (samples == 0)
+    {
+        table << "profile: no samples\n";
+        return;
+    }
+
+    auto flags = table.flags();
+    table << std::fixed << std::setprecision(1);
+    table << "profile: " << samples << " samples\n\n";
+    printTable(table, "function", functions, top);
+    table << '\n';
+    printTable(table, "line", lines, top);
+    table.flags(flags);
+}
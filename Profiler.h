@@ -0,0 +1,37 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_PROFILER_H
+#define LOXPLUS_PROFILER_H
+
+#include <csignal>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Interpreter.h"
+
+/*
+ * Sampling profiler for --profile. A CPU timer raises SIGPROF, whose
+ * handler only sets 'pending'; the interpreter records its Lox call stack
+ * at the next statement. Functions inlined at their call site are
+ * attributed to their caller.
+ * */
+class Profiler
+{
+public:
+    Profiler() = delete;
+
+    static inline volatile std::sig_atomic_t pending = 0;
+
+    static bool start(long intervalMicroseconds);
+    static void stop();
+
+    static void record(const std::vector<Interpreter::CallFrame> & frames, std::size_t line);
+
+    // writes the stacks in the collapsed format of flamegraph.pl and the 'top' hottest functions and lines.
+    static void report(std::ostream & collapsed, std::ostream & table, std::size_t top);
+};
+
+
+#endif //LOXPLUS_PROFILER_H
@@ -11,6 +11,14 @@ Resolver::Resolver(Interpreter & interpreter)
 
 }
 
+void Resolver::visitArrayExpr(ArrayExpr & expr)
+{
+    for (auto & element : expr.elements)
+    {
+        resolve(element);
+    }
+}
+
 void Resolver::visitAssignExpr(AssignExpr & expr)
 {
     resolve(expr.value);
@@ -43,6 +51,19 @@ void Resolver::visitGroupingExpr(GroupingExpr & expr)
     resolve(expr.expression);
 }
 
+void Resolver::visitIndexExpr(IndexExpr & expr)
+{
+    resolve(expr.object);
+    resolve(expr.index);
+}
+
+void Resolver::visitIndexSetExpr(IndexSetExpr & expr)
+{
+    resolve(expr.value);
+    resolve(expr.object);
+    resolve(expr.index);
+}
+
 void Resolver::visitLiteralExpr(LiteralExpr & expr)
 {
 }
@@ -77,9 +98,14 @@ void Resolver::visitSetExpr(SetExpr & expr)
 
 void Resolver::visitVariableExpr(VariableExpr & expr)
 {
-    if (!scopes.empty() && !scopes.back()[expr.name.lexeme])
+    if (!scopes.empty())
     {
-        LoxPlus::error(expr.name, "Cannot read local variable in its own initializer.");
+        auto & scope = scopes.back();
+        auto it = scope.find(expr.name.lexeme);
+        if (it != scope.end() && !it->second)
+        {
+            LoxPlus::error(expr.name, "Cannot read local variable in its own initializer.");
+        }
     }
 
     resolveLocal(expr, expr.name);
@@ -123,6 +149,22 @@ void Resolver::visitExpressionStmt(ExpressionStmt & stmt)
     resolve(stmt.expression);
 }
 
+void Resolver::visitForStmt(ForStmt & stmt)
+{
+    auto enclosingFunctions = functions;
+
+    beginScope();
+    if (stmt.initializer != nullptr) resolve(stmt.initializer);
+    if (stmt.condition != nullptr) resolve(stmt.condition);
+    if (stmt.increment != nullptr) resolve(stmt.increment);
+    resolve(stmt.body);
+    endScope();
+
+    // no function or class declared inside the loop means nothing can
+    // capture the body's scope, so a single environment can be reused.
+    interpreter.resolve(stmt, analyseLoop(stmt, functions == enclosingFunctions));
+}
+
 void Resolver::visitFunctionStmt(FunctionStmt & stmt)
 {
     declare(stmt.name);
@@ -158,6 +200,33 @@ void Resolver::visitReturnStmt(ReturnStmt & stmt)
         }
 
         resolve(stmt.value);
+
+        if (dynamic_cast<CallExpr*>(stmt.value) != nullptr)
+        {
+            interpreter.resolveTailCall(stmt);
+        }
+    }
+}
+
+void Resolver::visitYieldStmt(YieldStmt & stmt)
+{
+    if (currentFunction == FunctionType::None)
+    {
+        LoxPlus::error(stmt.keyword, "Cannot yield from top-level code.");
+    }
+    else if (currentFunction == FunctionType::Initializer)
+    {
+        LoxPlus::error(stmt.keyword, "Cannot yield from an initializer.");
+    }
+    else
+    {
+        // calling the function creates a generator instead of running its body.
+        interpreter.resolveGenerator(*currentDeclaration);
+    }
+
+    if (stmt.value != nullptr)
+    {
+        resolve(stmt.value);
     }
 }
 
@@ -202,6 +271,7 @@ void Resolver::resolve(Stmt* stmt)
 
 void Resolver::resolve(Expr* expr)
 {
+    expressions++;
     expr->accept(*this);
 }
 
@@ -240,7 +310,12 @@ void Resolver::resolveLocal(Expr & expr, Token name)
 void Resolver::resolveFunction(FunctionStmt & function, FunctionType type)
 {
     auto enclosingFunction = currentFunction;
+    auto enclosingDeclaration = currentDeclaration;
     currentFunction = type;
+    currentDeclaration = &function;
+    functions++;
+
+    auto enclosingExpressions = expressions;
 
     beginScope();
     for (auto & param : function.parameters)
@@ -251,5 +326,81 @@ void Resolver::resolveFunction(FunctionStmt & function, FunctionType type)
     resolve(function.body);
     endScope();
 
+    // a single statement of a few nodes can be evaluated in place of the call.
+    constexpr std::size_t inlineLimit = 16;
+    if (type != FunctionType::Initializer && function.body.size() == 1 && expressions - enclosingExpressions <= inlineLimit)
+    {
+        if (auto* stmt = dynamic_cast<ReturnStmt*>(function.body[0]); stmt != nullptr && stmt->value != nullptr)
+        {
+            interpreter.resolveInlineBody(function, { stmt->value, true });
+        }
+        else if (auto* stmt = dynamic_cast<ExpressionStmt*>(function.body[0]); stmt != nullptr)
+        {
+            interpreter.resolveInlineBody(function, { stmt->expression, false });
+        }
+    }
+
     currentFunction = enclosingFunction;
+    currentDeclaration = enclosingDeclaration;
+}
+
+Interpreter::LoopInfo Resolver::analyseLoop(ForStmt & stmt, bool closureFree)
+{
+    Interpreter::LoopInfo info;
+    info.reuseBodyEnvironment = closureFree;
+
+    /*
+     * recognise loops of the form :
+     *     for (var i = ...; i < limit; i = i + step) ...
+     * where 'limit' is a number literal or a variable and 'step' a number literal.
+     * */
+    auto* initializer = dynamic_cast<VarStmt*>(stmt.initializer);
+    auto* condition = dynamic_cast<BinaryExpr*>(stmt.condition);
+    auto* increment = dynamic_cast<AssignExpr*>(stmt.increment);
+    if (initializer == nullptr || condition == nullptr || increment == nullptr) return info;
+
+    const auto & name = initializer->name.lexeme;
+
+    switch (condition->op.type)
+    {
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+            break;
+        default:
+            return info;
+    }
+
+    auto* counter = dynamic_cast<VariableExpr*>(condition->left);
+    if (counter == nullptr || counter->name.lexeme != name) return info;
+
+    if (auto* limit = dynamic_cast<LiteralExpr*>(condition->right); limit != nullptr)
+    {
+        if (!limit->value.isDouble()) return info;
+    }
+    else if (auto* limit = dynamic_cast<VariableExpr*>(condition->right); limit != nullptr)
+    {
+        if (limit->name.lexeme == name) return info;
+    }
+    else
+    {
+        return info;
+    }
+
+    auto* next = dynamic_cast<BinaryExpr*>(increment->value);
+    if (increment->name.lexeme != name || next == nullptr) return info;
+    if (next->op.type != TokenType::PLUS && next->op.type != TokenType::MINUS) return info;
+
+    auto* self = dynamic_cast<VariableExpr*>(next->left);
+    auto* step = dynamic_cast<LiteralExpr*>(next->right);
+    if (self == nullptr || self->name.lexeme != name || step == nullptr || !step->value.isDouble()) return info;
+
+    info.counted = true;
+    info.variable = name;
+    info.comparison = condition->op.type;
+    info.limit = condition->right;
+    info.step = next->op.type == TokenType::PLUS ? step->value.asDouble() : -step->value.asDouble();
+
+    return info;
 }
@@ -15,10 +15,13 @@ class Resolver : public VisitorExpr, public VisitorStmt
 public:
     explicit Resolver(Interpreter & interpreter);
 
+    void visitArrayExpr(ArrayExpr & expr) override;
     void visitAssignExpr(AssignExpr & expr) override;
     void visitBinaryExpr(BinaryExpr & expr) override;
     void visitCallExpr(CallExpr & expr) override;
     void visitGroupingExpr(GroupingExpr & expr) override;
+    void visitIndexExpr(IndexExpr & expr) override;
+    void visitIndexSetExpr(IndexSetExpr & expr) override;
     void visitLiteralExpr(LiteralExpr & expr) override;
     void visitLogicalExpr(LogicalExpr & expr) override;
     void visitSetExpr(SetExpr & expr) override;
@@ -31,11 +34,13 @@ public:
     void visitClassStmt(ClassStmt & stmt) override;
     void visitGetExpr(GetExpr & expr) override;
     void visitExpressionStmt(ExpressionStmt & stmt) override;
+    void visitForStmt(ForStmt & stmt) override;
     void visitFunctionStmt(FunctionStmt & stmt) override;
     void visitIfStmt(IfStmt & stmt) override;
     void visitPrintStmt(PrintStmt & stmt) override;
     void visitReturnStmt(ReturnStmt & stmt) override;
     void visitVarStmt(VarStmt & stmt) override;
+    void visitYieldStmt(YieldStmt & stmt) override;
 
     void resolve(const std::vector<Stmt*> & statements);
 
@@ -57,7 +62,10 @@ private:
     Interpreter & interpreter;
     std::vector<std::map<std::string, bool>> scopes;
     FunctionType currentFunction = FunctionType::None;
+    FunctionStmt* currentDeclaration = nullptr;
     ClassType currentClass = ClassType::None;
+    std::size_t functions = 0;
+    std::size_t expressions = 0;
 
     void beginScope();
 
@@ -73,6 +81,8 @@ private:
     void resolveLocal(Expr & expr, Token name);
 
     void resolveFunction(FunctionStmt & stmt, FunctionType type);
+
+    Interpreter::LoopInfo analyseLoop(ForStmt & stmt, bool closureFree);
 };
 
 
@@ -9,3 +9,10 @@ Return::Return(Object value)
 {
 
 }
+
+Return::Return(LoxFunction* tailCall, Arguments arguments)
+    : tailCall { tailCall }, arity { arguments.size() }
+{
+    std::copy(arguments.begin(), arguments.end(), this->arguments.begin());
+
+}
@@ -6,12 +6,17 @@
 #define LOXPLUS_RETURN_H
 
 
+#include <array>
+#include "Arguments.h"
 #include "Object.h"
 
+class LoxFunction;
+
 class Return
 {
 public:
     explicit Return(Object value);
+    Return(LoxFunction* tailCall, Arguments arguments);
 
     Return(const Return &) = delete;
     Return(Return &&) = default;
@@ -19,6 +24,12 @@ public:
     Return & operator=(Return &&) = default;
 
     Object value;
+
+    // set when returning the result of a call in tail position, the caller
+    // reuses its frame to run it instead of nesting a new one.
+    LoxFunction* tailCall = nullptr;
+    std::array<Object, Arguments::capacity> arguments;
+    std::size_t arity = 0;
 };
 
 
@@ -7,6 +7,7 @@
 #include <iostream>
 #include "Scanner.h"
 #include "Lox-plus.h"
+#include "Numbers.h"
 
 Scanner::Scanner(std::string_view source)
     : source { source }
@@ -41,6 +42,8 @@ void Scanner::scanToken()
         case ')': addToken(TokenType::RIGHT_PAREN); break;
         case '{': addToken(TokenType::LEFT_BRACE); break;
         case '}': addToken(TokenType::RIGHT_BRACE); break;
+        case '[': addToken(TokenType::LEFT_BRACKET); break;
+        case ']': addToken(TokenType::RIGHT_BRACKET); break;
         case ',': addToken(TokenType::COMMA); break;
         case '.': addToken(TokenType::DOT); break;
         case '-': addToken(TokenType::MINUS); break;
@@ -161,8 +164,12 @@ void Scanner::number()
         while (isDigit(peek())) advance();
     }
 
-    auto value_str = source.substr(start, current - start);
-    double d = std::stod(std::string(value_str));
+    // only digits were consumed, the parse can only fail on the range.
+    double d = 0;
+    if (!Numbers::parse(source.substr(start, current - start), d))
+    {
+        LoxPlus::error(line, "Number literal out of range.");
+    }
     addToken(TokenType::NUMBER, d);
 }
 
@@ -66,7 +66,8 @@ private:
         { "this",   TokenType::THIS   },
         { "true",   TokenType::TRUE   },
         { "var",    TokenType::VAR    },
-        { "while",  TokenType::WHILE  }
+        { "while",  TokenType::WHILE  },
+        { "yield",  TokenType::YIELD  }
     };
 };
 
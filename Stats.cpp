@@ -0,0 +1,192 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#include "Stats.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace
+{
+    struct Phase
+    {
+        const char* name;
+        double milliseconds;
+        std::size_t objects;
+    };
+
+    // deque: counters are referenced by the types that registered them.
+    std::deque<Stats::Counter> counters;
+    std::vector<Phase> phases;
+    std::vector<std::pair<const char*, std::size_t>> counts;
+    std::vector<std::pair<const char*, std::vector<std::pair<std::string, std::size_t>>>> histograms;
+
+    std::size_t created = 0;
+    std::size_t liveObjects = 0;
+    std::size_t liveBytes = 0;
+    std::size_t peakObjects = 0;
+    std::size_t peakBytes = 0;
+
+    const char* currentPhase = nullptr;
+    std::chrono::steady_clock::time_point phaseStart;
+    std::size_t phaseObjects = 0;
+}
+
+std::string Stats::typeName(const std::type_info & type)
+{
+#if defined(__GNUG__)
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled { abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free };
+    if (status == 0) return demangled.get();
+#endif
+    return type.name();
+}
+
+Stats::Counter & Stats::registerType(const std::type_info & type, std::size_t size)
+{
+    return counters.emplace_back(Counter { typeName(type), size });
+}
+
+void Stats::allocated(Counter & counter)
+{
+    counter.created++;
+    created++;
+
+    liveObjects++;
+    liveBytes += counter.size;
+    peakObjects = std::max(peakObjects, liveObjects);
+    peakBytes = std::max(peakBytes, liveBytes);
+}
+
+void Stats::released(std::size_t objects, std::size_t bytes)
+{
+    liveObjects -= objects;
+    liveBytes -= bytes;
+}
+
+std::size_t Stats::objects()
+{
+    return created;
+}
+
+void Stats::beginPhase(const char* name)
+{
+    if (!enabled) return;
+
+    endPhase();
+    currentPhase = name;
+    phaseObjects = created;
+    phaseStart = std::chrono::steady_clock::now();
+}
+
+void Stats::endPhase()
+{
+    if (!enabled || currentPhase == nullptr) return;
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - phaseStart;
+    phases.push_back({ currentPhase, elapsed.count(), created - phaseObjects });
+    currentPhase = nullptr;
+}
+
+void Stats::count(const char* name, std::size_t value)
+{
+    if (!enabled) return;
+
+    counts.emplace_back(name, value);
+}
+
+void Stats::histogram(const char* name, std::vector<std::pair<std::string, std::size_t>> buckets)
+{
+    if (!enabled) return;
+
+    histograms.emplace_back(name, std::move(buckets));
+}
+
+void Stats::report(std::ostream & out, bool json)
+{
+    endPhase();
+
+    std::vector<const Counter*> types;
+    for (auto & counter : counters)
+    {
+        if (counter.created > 0) types.push_back(&counter);
+    }
+    std::sort(types.begin(), types.end(), [](const Counter* a, const Counter* b) { return a->created > b->created; });
+
+    double total = 0;
+    for (auto & phase : phases)
+    {
+        total += phase.milliseconds;
+    }
+
+    auto flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+
+    if (json)
+    {
+        out << "{\"phases\": [";
+        for (std::size_t i = 0; i < phases.size(); i++)
+        {
+            out << (i ? ", " : "") << "{\"name\": \"" << phases[i].name << "\", \"ms\": " << phases[i].milliseconds << ", \"objects\": " << phases[i].objects << "}";
+        }
+        out << "], \"total_ms\": " << total;
+        for (auto & [name, value] : counts)
+        {
+            out << ", \"" << name << "\": " << value;
+        }
+        for (auto & [name, buckets] : histograms)
+        {
+            out << ", \"" << name << "\": {";
+            for (std::size_t i = 0; i < buckets.size(); i++)
+            {
+                out << (i ? ", " : "") << "\"" << buckets[i].first << "\": " << buckets[i].second;
+            }
+            out << "}";
+        }
+        out << ", \"objects\": " << created << ", \"peak_live_objects\": " << peakObjects << ", \"peak_live_bytes\": " << peakBytes;
+        out << ", \"types\": {";
+        for (std::size_t i = 0; i < types.size(); i++)
+        {
+            out << (i ? ", " : "") << "\"" << types[i]->name << "\": {\"created\": " << types[i]->created << ", \"bytes\": " << types[i]->created * types[i]->size << "}";
+        }
+        out << "}}\n";
+    }
+    else
+    {
+        out << std::left << std::setw(10) << "phase" << std::right << std::setw(12) << "ms" << std::setw(12) << "objects" << '\n';
+        for (auto & phase : phases)
+        {
+            out << std::left << std::setw(10) << phase.name << std::right << std::setw(12) << phase.milliseconds << std::setw(12) << phase.objects << '\n';
+        }
+        out << std::left << std::setw(10) << "total" << std::right << std::setw(12) << total << std::setw(12) << created << "\n\n";
+
+        for (auto & [name, value] : counts)
+        {
+            out << name << ": " << value << '\n';
+        }
+        for (auto & [name, buckets] : histograms)
+        {
+            out << name << ":\n";
+            for (auto & [label, value] : buckets)
+            {
+                out << "  " << std::left << std::setw(10) << label << std::right << std::setw(10) << value << '\n';
+            }
+        }
+        out << "peak live objects: " << peakObjects << " (" << peakBytes << " bytes)\n\n";
+
+        out << std::left << std::setw(20) << "type" << std::right << std::setw(12) << "created" << std::setw(12) << "bytes" << '\n';
+        for (auto type : types)
+        {
+            out << std::left << std::setw(20) << type->name << std::right << std::setw(12) << type->created << std::setw(12) << type->created * type->size << '\n';
+        }
+    }
+
+    out.flags(flags);
+}
@@ -0,0 +1,65 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+#ifndef LOXPLUS_STATS_H
+#define LOXPLUS_STATS_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+/*
+ * Counters reported by --stats: wall time and objects created by each
+ * phase, and the objects created through CreatableType per type. Bytes are
+ * the size of the objects themselves, not what they own (strings, maps).
+ * Nothing is recorded unless 'enabled' is set.
+ * */
+class Stats
+{
+public:
+    struct Counter
+    {
+        std::string name;
+        std::size_t size;
+        std::size_t created = 0;
+    };
+
+    Stats() = delete;
+
+    static inline bool enabled = false;
+
+    template <typename T>
+    static Counter & counter()
+    {
+        static Counter & counter = registerType(typeid(T), sizeof(T));
+        return counter;
+    }
+
+    static void allocated(Counter & counter);
+    // objects destroyed by the garbage collector.
+    static void released(std::size_t objects, std::size_t bytes);
+    // objects created so far, of all types.
+    static std::size_t objects();
+
+    // ends the current phase, if any, and starts timing 'name'.
+    static void beginPhase(const char* name);
+    static void endPhase();
+    static void count(const char* name, std::size_t value);
+    // labelled buckets, reported after the counts.
+    static void histogram(const char* name, std::vector<std::pair<std::string, std::size_t>> buckets);
+
+    static void report(std::ostream & out, bool json);
+
+    // demangled name of 'type'.
+    static std::string typeName(const std::type_info & type);
+
+private:
+    static Counter & registerType(const std::type_info & type, std::size_t size);
+};
+
+
+#endif //LOXPLUS_STATS_H
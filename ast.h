@@ -6,11 +6,14 @@
 #include "CreatableType.h"
 #include <vector>
 
+class ArrayExpr;
 class AssignExpr;
 class BinaryExpr;
 class CallExpr;
 class GetExpr;
 class GroupingExpr;
+class IndexExpr;
+class IndexSetExpr;
 class LiteralExpr;
 class LogicalExpr;
 class SetExpr;
@@ -22,11 +25,14 @@ struct VisitorExpr
 {
 	virtual ~VisitorExpr() = default;
 
+	virtual void visitArrayExpr(ArrayExpr & expr) = 0;
 	virtual void visitAssignExpr(AssignExpr & expr) = 0;
 	virtual void visitBinaryExpr(BinaryExpr & expr) = 0;
 	virtual void visitCallExpr(CallExpr & expr) = 0;
 	virtual void visitGetExpr(GetExpr & expr) = 0;
 	virtual void visitGroupingExpr(GroupingExpr & expr) = 0;
+	virtual void visitIndexExpr(IndexExpr & expr) = 0;
+	virtual void visitIndexSetExpr(IndexSetExpr & expr) = 0;
 	virtual void visitLiteralExpr(LiteralExpr & expr) = 0;
 	virtual void visitLogicalExpr(LogicalExpr & expr) = 0;
 	virtual void visitSetExpr(SetExpr & expr) = 0;
@@ -40,6 +46,22 @@ struct Expr
 	virtual void accept(VisitorExpr & visitor) = 0;
 };
 
+struct ArrayExpr : CreatableType<ArrayExpr>, Expr
+{
+	ArrayExpr(Token bracket, std::vector<Expr*> elements)
+		: bracket { std::move(bracket) }, elements { std::move(elements) }
+	{
+	}
+
+	Token bracket;
+	std::vector<Expr*> elements;
+
+	void accept(VisitorExpr & visitor) override
+	{
+		visitor.visitArrayExpr(*this);
+	}
+};
+
 struct AssignExpr : CreatableType<AssignExpr>, Expr
 {
 	AssignExpr(Token name, Expr* value)
@@ -121,6 +143,41 @@ struct GroupingExpr : CreatableType<GroupingExpr>, Expr
 	}
 };
 
+struct IndexExpr : CreatableType<IndexExpr>, Expr
+{
+	IndexExpr(Expr* object, Token bracket, Expr* index)
+		: object { object }, bracket { std::move(bracket) }, index { index }
+	{
+	}
+
+	Expr* object;
+	Token bracket;
+	Expr* index;
+
+	void accept(VisitorExpr & visitor) override
+	{
+		visitor.visitIndexExpr(*this);
+	}
+};
+
+struct IndexSetExpr : CreatableType<IndexSetExpr>, Expr
+{
+	IndexSetExpr(Expr* object, Token bracket, Expr* index, Expr* value)
+		: object { object }, bracket { std::move(bracket) }, index { index }, value { value }
+	{
+	}
+
+	Expr* object;
+	Token bracket;
+	Expr* index;
+	Expr* value;
+
+	void accept(VisitorExpr & visitor) override
+	{
+		visitor.visitIndexSetExpr(*this);
+	}
+};
+
 struct LiteralExpr : CreatableType<LiteralExpr>, Expr
 {
 	explicit LiteralExpr(Object value)
@@ -219,12 +276,14 @@ struct VariableExpr : CreatableType<VariableExpr>, Expr
 class BlockStmt;
 class ClassStmt;
 class ExpressionStmt;
+class ForStmt;
 class FunctionStmt;
 class IfStmt;
 class PrintStmt;
 class ReturnStmt;
 class VarStmt;
 class WhileStmt;
+class YieldStmt;
 
 struct VisitorStmt
 {
@@ -233,17 +292,21 @@ struct VisitorStmt
 	virtual void visitBlockStmt(BlockStmt & stmt) = 0;
 	virtual void visitClassStmt(ClassStmt & stmt) = 0;
 	virtual void visitExpressionStmt(ExpressionStmt & stmt) = 0;
+	virtual void visitForStmt(ForStmt & stmt) = 0;
 	virtual void visitFunctionStmt(FunctionStmt & stmt) = 0;
 	virtual void visitIfStmt(IfStmt & stmt) = 0;
 	virtual void visitPrintStmt(PrintStmt & stmt) = 0;
 	virtual void visitReturnStmt(ReturnStmt & stmt) = 0;
 	virtual void visitVarStmt(VarStmt & stmt) = 0;
 	virtual void visitWhileStmt(WhileStmt & stmt) = 0;
+	virtual void visitYieldStmt(YieldStmt & stmt) = 0;
 };
 
 struct Stmt
 {
 	virtual void accept(VisitorStmt & visitor) = 0;
+
+	std::size_t line = 0;
 };
 
 struct BlockStmt : CreatableType<BlockStmt>, Stmt
@@ -292,6 +355,25 @@ struct ExpressionStmt : CreatableType<ExpressionStmt>, Stmt
 	}
 };
 
+struct ForStmt : CreatableType<ForStmt>, Stmt
+{
+	ForStmt(Token keyword, Stmt* initializer, Expr* condition, Expr* increment, Stmt* body)
+		: keyword { std::move(keyword) }, initializer { initializer }, condition { condition }, increment { increment }, body { body }
+	{
+	}
+
+	Token keyword;
+	Stmt* initializer;
+	Expr* condition;
+	Expr* increment;
+	Stmt* body;
+
+	void accept(VisitorStmt & visitor) override
+	{
+		visitor.visitForStmt(*this);
+	}
+};
+
 struct FunctionStmt : CreatableType<FunctionStmt>, Stmt
 {
 	FunctionStmt(Token name, std::vector<Token> parameters, std::vector<Stmt*> body)
@@ -389,4 +471,20 @@ struct WhileStmt : CreatableType<WhileStmt>, Stmt
 	}
 };
 
+struct YieldStmt : CreatableType<YieldStmt>, Stmt
+{
+	YieldStmt(Token keyword, Expr* value)
+		: keyword { std::move(keyword) }, value { value }
+	{
+	}
+
+	Token keyword;
+	Expr* value;
+
+	void accept(VisitorStmt & visitor) override
+	{
+		visitor.visitYieldStmt(*this);
+	}
+};
+
 #endif //LOXPLUS_AST_H
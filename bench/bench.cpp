@@ -0,0 +1,281 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+// Runs the Lox workloads of the bench directory, plus the scanner and the
+// parser on a large generated source, and prints the results as JSON.
+// Every run happens in its own process so the peak RSS of one workload
+// does not hide the next one, the best time of all runs is reported.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "../Heap.h"
+#include "../Lox-plus.h"
+#include "../Parser.h"
+#include "../Scanner.h"
+
+#ifndef LOXPLUS_BENCH_DIR
+#define LOXPLUS_BENCH_DIR "bench"
+#endif
+#ifndef LOXPLUS_BUILD_TYPE
+#define LOXPLUS_BUILD_TYPE ""
+#endif
+
+static std::atomic<std::size_t> allocations { 0 };
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto memory = std::malloc(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+struct Sample
+{
+    bool succeeded;
+    std::size_t ops;
+    double nanoseconds;
+    // operator new calls, and the objects the heap allocated on its own.
+    std::size_t allocations;
+    std::size_t heapAllocations;
+    long peakRss;
+};
+
+struct Workload
+{
+    std::string name;
+    // returns the number of operations performed, 0 on failure.
+    std::function<std::size_t()> run;
+};
+
+static Sample runIsolated(const Workload & workload)
+{
+    Sample sample {};
+
+    int channel[2];
+    if (pipe(channel) != 0) return sample;
+
+    std::cout.flush();
+
+    auto child = fork();
+    if (child == 0)
+    {
+        close(channel[0]);
+
+        // the workloads print their result, keep stdout for the report.
+        auto null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+
+        auto before = allocations.load();
+        auto heapBefore = Heap::statistics().allocatedObjects;
+        auto start = std::chrono::steady_clock::now();
+        sample.ops = workload.run();
+        auto end = std::chrono::steady_clock::now();
+
+        sample.succeeded = sample.ops != 0;
+        sample.nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+        sample.allocations = allocations.load() - before;
+        sample.heapAllocations = Heap::statistics().allocatedObjects - heapBefore;
+
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        sample.peakRss = usage.ru_maxrss;
+
+        auto written = write(channel[1], &sample, sizeof(sample));
+        _exit(written == sizeof(sample) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    if (child > 0)
+    {
+        if (read(channel[0], &sample, sizeof(sample)) != sizeof(sample))
+        {
+            sample.succeeded = false;
+        }
+        waitpid(child, nullptr, 0);
+    }
+    close(channel[0]);
+
+    return sample;
+}
+
+// reads the "// ops: N" header of a workload.
+static std::size_t declaredOps(const std::filesystem::path & path)
+{
+    std::ifstream file { path };
+    std::string line;
+    std::getline(file, line);
+
+    const std::string header = "// ops:";
+    if (line.compare(0, header.size(), header) != 0) return 1;
+
+    return std::max(1ul, std::strtoul(line.c_str() + header.size(), nullptr, 10));
+}
+
+static Workload script(const std::filesystem::path & path)
+{
+    auto ops = declaredOps(path);
+    return { path.stem().string(), [path, ops]() -> std::size_t {
+        return LoxPlus::runFile(path.c_str()) == 0 ? ops : 0;
+    } };
+}
+
+static std::string generatedSource(int copies)
+{
+    std::string source;
+    for (int i = 0; i < copies; i++)
+    {
+        auto n = std::to_string(i);
+        source += "class Shape" + n + " {\n"
+                  "    init(width, height) { this.width = width; this.height = height; }\n"
+                  "    area() { return this.width * this.height; }\n"
+                  "}\n"
+                  "fun compute" + n + "(a, b) {\n"
+                  "    var total = 0;\n"
+                  "    for (var i = 0; i < a; i = i + 1) {\n"
+                  "        if (i > b and !(i == 3)) total = total + i * 2.5; else total = total - 1;\n"
+                  "    }\n"
+                  "    // a comment that the scanner has to skip\n"
+                  "    while (total >= 100) { total = total / 2; }\n"
+                  "    return Shape" + n + "(total, \"label " + n + "\").area();\n"
+                  "}\n";
+    }
+    return source;
+}
+
+// scanner and parser only, one op per token.
+static Workload parsing()
+{
+    return { "scan_parse", [source = generatedSource(5000)]() -> std::size_t {
+        Scanner scanner(source);
+        auto tokens = scanner.scanTokens();
+
+        Parser parser(tokens);
+        auto statements = parser.parse();
+
+        return statements.empty() ? 0 : tokens.size();
+    } };
+}
+
+static void usage()
+{
+    std::cerr << "Usage: loxplus-bench [--runs=N] [--dir=path] [workload...]\n";
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 5;
+    std::filesystem::path directory = LOXPLUS_BENCH_DIR;
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--runs=", 7) == 0)
+        {
+            runs = std::atoi(argv[i] + 7);
+            if (runs <= 0)
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (std::strncmp(argv[i], "--dir=", 6) == 0)
+        {
+            directory = argv[i] + 6;
+        }
+        else if (argv[i][0] != '-')
+        {
+            selected.emplace_back(argv[i]);
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<std::filesystem::path> scripts;
+    std::error_code error;
+    for (auto & entry : std::filesystem::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() == ".lox") scripts.push_back(entry.path());
+    }
+    std::sort(scripts.begin(), scripts.end());
+
+    std::vector<Workload> workloads;
+    for (auto & path : scripts)
+    {
+        workloads.push_back(script(path));
+    }
+    workloads.push_back(parsing());
+
+    if (!selected.empty())
+    {
+        workloads.erase(std::remove_if(workloads.begin(), workloads.end(), [&](const Workload & workload) {
+            return std::find(selected.begin(), selected.end(), workload.name) == selected.end();
+        }), workloads.end());
+    }
+
+    bool failed = false;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "{\n  \"build\": \"" << LOXPLUS_BUILD_TYPE << "\",\n  \"runs\": " << runs << ",\n  \"workloads\": [";
+    for (std::size_t w = 0; w < workloads.size(); w++)
+    {
+        std::vector<Sample> samples;
+        for (int r = 0; r < runs; r++)
+        {
+            samples.push_back(runIsolated(workloads[w]));
+        }
+
+        auto succeeded = std::all_of(samples.begin(), samples.end(), [](const Sample & sample) { return sample.succeeded; });
+        failed = failed || !succeeded;
+
+        std::sort(samples.begin(), samples.end(), [](const Sample & a, const Sample & b) { return a.nanoseconds < b.nanoseconds; });
+        auto & best = samples.front();
+        auto & median = samples[samples.size() / 2];
+        auto peakRss = std::max_element(samples.begin(), samples.end(), [](const Sample & a, const Sample & b) { return a.peakRss < b.peakRss; })->peakRss;
+        auto ops = static_cast<double>(std::max<std::size_t>(best.ops, 1));
+
+        std::cout << (w ? ",\n" : "\n")
+                  << "    { \"name\": \"" << workloads[w].name << "\""
+                  << ", \"ok\": " << (succeeded ? "true" : "false")
+                  << ", \"ops\": " << best.ops
+                  << ", \"ns_per_op\": " << best.nanoseconds / ops
+                  << ", \"min_ns\": " << best.nanoseconds
+                  << ", \"median_ns\": " << median.nanoseconds
+                  << ", \"allocations\": " << best.allocations
+                  << ", \"allocations_per_op\": " << best.allocations / ops
+                  << ", \"heap_allocations\": " << best.heapAllocations
+                  << ", \"heap_allocations_per_op\": " << best.heapAllocations / ops
+                  << ", \"peak_rss_kb\": " << peakRss << " }";
+    }
+    std::cout << "\n  ]\n}\n";
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+// Measures the cost of a Lox call with 0 to 8 arguments, and the heap
+// allocations it performs, against an empty loop of the same length.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include "../Lox-plus.h"
+
+static std::atomic<std::size_t> allocations { 0 };
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto memory = std::malloc(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+struct Measure
+{
+    double nanoseconds;
+    std::size_t allocations;
+};
+
+static Measure measure(const std::string & source)
+{
+    auto before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    LoxPlus::run(source);
+    auto end = std::chrono::steady_clock::now();
+
+    return { std::chrono::duration<double, std::nano>(end - start).count(), allocations.load() - before };
+}
+
+int main(int argc, char** argv)
+{
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 200000;
+    const std::string loop = "for (var i = 0; i < " + std::to_string(iterations) + "; i = i + 1) { ";
+
+    auto empty = measure(loop + "}");
+
+    std::cout << "arguments  ns/call  allocations/call\n";
+    for (int arity : { 0, 1, 2, 4, 8 })
+    {
+        std::string parameters, arguments;
+        for (int i = 0; i < arity; i++)
+        {
+            parameters += (i ? ", p" : "p") + std::to_string(i);
+            arguments += i ? ", 1" : "1";
+        }
+
+        // an empty body is never inlined, so this is the full call path.
+        auto call = measure("fun f(" + parameters + ") {}\n" + loop + "f(" + arguments + "); }");
+
+        std::cout << std::setw(9) << arity
+                  << std::setw(9) << std::fixed << std::setprecision(1) << (call.nanoseconds - empty.nanoseconds) / iterations
+                  << std::setw(18) << std::setprecision(2) << static_cast<double>(call.allocations - empty.allocations) / iterations
+                  << '\n';
+    }
+
+    return 0;
+}
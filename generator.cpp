@@ -50,11 +50,14 @@ int main(int argc, char** argv)
         << "\n";
 
     defineAst(file, "Expr", {
+        "Array    : Token bracket, std::vector<Expr*> elements",
         "Assign   : Token name, Expr* value",
         "Binary   : Expr* left, Token op, Expr* right",
         "Call     : Expr* callee, Token paren, std::vector<Expr*> arguments",
         "Get      : Expr* object, Token name",
         "Grouping : Expr* expression",
+        "Index    : Expr* object, Token bracket, Expr* index",
+        "IndexSet : Expr* object, Token bracket, Expr* index, Expr* value",
         "Literal  : Object value",
         "Logical  : Expr* left, Token op, Expr* right",
         "Set      : Expr* object, Token name, Expr* value",
@@ -67,12 +70,14 @@ int main(int argc, char** argv)
         "Block      : std::vector<Stmt*> statements",
         "Class      : Token name, std::vector<FunctionStmt*> methods",
         "Expression : Expr* expression",
+        "For        : Token keyword, Stmt* initializer, Expr* condition, Expr* increment, Stmt* body",
         "Function   : Token name, std::vector<Token> parameters, std::vector<Stmt*> body",
         "If         : Expr* condition, Stmt* thenBranch, Stmt* elseBranch",
         "Print      : Expr* expression",
         "Return     : Token keyword, Expr* value",
         "Var        : Token name, Expr* initializer",
-        "While      : Expr* condition, Stmt* body"
+        "While      : Expr* condition, Stmt* body",
+        "Yield      : Token keyword, Expr* value"
     });
 
     file<< "#endif //LOXPLUS_AST_H\n";
@@ -103,8 +108,14 @@ void defineAst(std::ofstream & file, std::string_view baseName, std::vector<std:
 
     file<< "struct " << baseName << "\n"
         << "{\n"
-        << "\tvirtual void accept(Visitor" << baseName << " & visitor) = 0;\n"
-        << "};\n"
+        << "\tvirtual void accept(Visitor" << baseName << " & visitor) = 0;\n";
+    if (baseName == "Stmt")
+    {
+        // set by the parser, used to attribute the execution to the source.
+        file<< "\n"
+            << "\tstd::size_t line = 0;\n";
+    }
+    file<< "};\n"
         << "\n";
 
     for (auto & type : typeFields)
@@ -1,16 +1,114 @@
 #include <iostream>
+#include <cstring>
+#include <string>
 #include "Lox-plus.h"
 
+static void usage()
+{
+    std::cout << "Usage: lox-plus [--max-depth=N] [--stats[=json]] [--profile[=out.folded]] [--counts] [--alloc-profile] [--gc-slice=N] [--gc-concurrent] [--generator-stack=KiB] [--no-simd] [--output-buffer=N] [--flush=line|size] [file.lox]\n";
+}
+
 int main(int argc, char** argv)
 {
-    if (argc > 2)
+    const char* script = nullptr;
+
+    for (int i = 1; i < argc; i++)
     {
-        std::cout << "Usage: lox-plus [file.lox]\n";
-        return 1;
+        if (std::strncmp(argv[i], "--max-depth=", 12) == 0)
+        {
+            auto depth = std::strtoul(argv[i] + 12, nullptr, 10);
+            if (depth == 0)
+            {
+                usage();
+                return 1;
+            }
+            LoxPlus::options.maxCallDepth = depth;
+        }
+        else if (std::strncmp(argv[i], "--gc-slice=", 11) == 0)
+        {
+            auto budget = std::strtoul(argv[i] + 11, nullptr, 10);
+            if (budget == 0)
+            {
+                usage();
+                return 1;
+            }
+            LoxPlus::options.gcSliceBudget = budget;
+        }
+        else if (std::strcmp(argv[i], "--gc-concurrent") == 0)
+        {
+            LoxPlus::options.gcConcurrent = true;
+        }
+        else if (std::strncmp(argv[i], "--generator-stack=", 18) == 0)
+        {
+            auto size = std::strtoul(argv[i] + 18, nullptr, 10);
+            if (size == 0)
+            {
+                usage();
+                return 1;
+            }
+            LoxPlus::options.generatorStack = size;
+        }
+        else if (std::strcmp(argv[i], "--no-simd") == 0)
+        {
+            LoxPlus::options.simd = false;
+        }
+        else if (std::strncmp(argv[i], "--output-buffer=", 16) == 0)
+        {
+            char* end;
+            auto size = std::strtoul(argv[i] + 16, &end, 10);
+            if (end == argv[i] + 16 || *end != '\0')
+            {
+                usage();
+                return 1;
+            }
+            LoxPlus::options.outputBuffer = size;
+        }
+        else if (std::strcmp(argv[i], "--flush=line") == 0)
+        {
+            LoxPlus::options.flush = LoxPlus::Options::Flush::Line;
+        }
+        else if (std::strcmp(argv[i], "--flush=size") == 0)
+        {
+            LoxPlus::options.flush = LoxPlus::Options::Flush::Size;
+        }
+        else if (std::strcmp(argv[i], "--stats") == 0)
+        {
+            LoxPlus::options.stats = LoxPlus::Options::Stats::Text;
+        }
+        else if (std::strcmp(argv[i], "--stats=json") == 0)
+        {
+            LoxPlus::options.stats = LoxPlus::Options::Stats::Json;
+        }
+        else if (std::strcmp(argv[i], "--alloc-profile") == 0)
+        {
+            LoxPlus::options.allocationProfile = true;
+        }
+        else if (std::strcmp(argv[i], "--counts") == 0)
+        {
+            LoxPlus::options.counts = true;
+        }
+        else if (std::strcmp(argv[i], "--profile") == 0)
+        {
+            LoxPlus::options.profile = "profile.folded";
+        }
+        else if (std::strncmp(argv[i], "--profile=", 10) == 0 && argv[i][10] != '\0')
+        {
+            LoxPlus::options.profile = argv[i] + 10;
+        }
+        else if (script == nullptr && argv[i][0] != '-')
+        {
+            script = argv[i];
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
     }
-    else if (argc == 2)
+
+    if (script != nullptr)
     {
-        return LoxPlus::runFile(argv[1]);
+        return LoxPlus::runFile(script);
     }
     else
     {
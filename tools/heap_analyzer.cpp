@@ -0,0 +1,247 @@
+//
+// Created by minirop on 18/10/26.
+//
+
+// Reads a snapshot written by heapSnapshot() or SIGUSR1, computes the
+// dominator tree (Cooper, Harvey & Kennedy's iterative algorithm) and
+// prints the objects retaining the most memory, with their dominator path.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../HeapSnapshot.h"
+
+struct Node
+{
+    HeapSnapshot::Kind kind;
+    std::uint64_t size;
+    std::string label;
+    std::vector<std::uint32_t> edges;
+};
+
+struct Snapshot
+{
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> roots;
+};
+
+template <typename T>
+static bool get(std::ifstream & file, T & value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+static bool load(const char* path, Snapshot & snapshot)
+{
+    std::ifstream file { path, std::ios::binary };
+
+    char magic[sizeof(HeapSnapshot::magic)];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, HeapSnapshot::magic, sizeof(magic)) != 0) return false;
+
+    std::uint32_t count;
+    if (!get(file, count)) return false;
+    snapshot.nodes.resize(count);
+
+    for (auto & node : snapshot.nodes)
+    {
+        std::uint32_t length, edges;
+        if (!get(file, node.kind) || !get(file, node.size) || !get(file, length)) return false;
+        if (node.kind > HeapSnapshot::Kind::Generator) return false;
+        node.label.resize(length);
+        if (!file.read(&node.label[0], length) || !get(file, edges)) return false;
+        node.edges.resize(edges);
+        for (auto & edge : node.edges)
+        {
+            if (!get(file, edge) || edge >= count) return false;
+        }
+    }
+
+    std::uint32_t roots;
+    if (!get(file, roots)) return false;
+    snapshot.roots.resize(roots);
+    for (auto & root : snapshot.roots)
+    {
+        if (!get(file, root) || root >= count) return false;
+    }
+
+    return true;
+}
+
+static const char* kindName(HeapSnapshot::Kind kind)
+{
+    switch (kind)
+    {
+        case HeapSnapshot::Kind::Environment: return "Environment";
+        case HeapSnapshot::Kind::Instance: return "Instance";
+        case HeapSnapshot::Kind::Class: return "Class";
+        case HeapSnapshot::Kind::Function: return "Function";
+        case HeapSnapshot::Kind::Native: return "Native";
+        case HeapSnapshot::Kind::String: return "String";
+        case HeapSnapshot::Kind::Array: return "Array";
+        case HeapSnapshot::Kind::Float64Array: return "Float64Array";
+        case HeapSnapshot::Kind::Map: return "Map";
+        case HeapSnapshot::Kind::StringBuilder: return "StringBuilder";
+        case HeapSnapshot::Kind::File: return "File";
+        case HeapSnapshot::Kind::Generator: return "Generator";
+    }
+    return "?";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: heap-analyzer snapshot [top]\n";
+        return 1;
+    }
+
+    Snapshot snapshot;
+    if (!load(argv[1], snapshot))
+    {
+        std::cerr << "Cannot read heap snapshot '" << argv[1] << "'.\n";
+        return 1;
+    }
+    std::size_t top = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+    // a virtual root, referencing the interpreter's roots, dominates everything.
+    const auto count = snapshot.nodes.size();
+    const auto root = count;
+    auto successors = [&](std::size_t node) -> const std::vector<std::uint32_t> & {
+        return node == root ? snapshot.roots : snapshot.nodes[node].edges;
+    };
+
+    // postorder numbers, iteratively to survive long chains.
+    const std::size_t unvisited = SIZE_MAX;
+    std::vector<std::size_t> postorder(count + 1, unvisited);
+    std::vector<std::size_t> order;
+    std::vector<std::pair<std::size_t, std::size_t>> work { { root, 0 } };
+    std::vector<bool> seen(count + 1, false);
+    seen[root] = true;
+    while (!work.empty())
+    {
+        auto & [node, next] = work.back();
+        auto & edges = successors(node);
+        if (next < edges.size())
+        {
+            auto target = edges[next++];
+            if (!seen[target])
+            {
+                seen[target] = true;
+                work.emplace_back(target, 0);
+            }
+        }
+        else
+        {
+            postorder[node] = order.size();
+            order.push_back(node);
+            work.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    std::vector<std::vector<std::size_t>> predecessors(count + 1);
+    for (auto node : order)
+    {
+        for (auto target : successors(node))
+        {
+            predecessors[target].push_back(node);
+        }
+    }
+
+    std::vector<std::size_t> dominator(count + 1, unvisited);
+    dominator[root] = root;
+    auto intersect = [&](std::size_t a, std::size_t b) {
+        while (a != b)
+        {
+            while (postorder[a] < postorder[b]) a = dominator[a];
+            while (postorder[b] < postorder[a]) b = dominator[b];
+        }
+        return a;
+    };
+
+    for (bool changed = true; changed; )
+    {
+        changed = false;
+        for (auto node : order)
+        {
+            if (node == root) continue;
+
+            auto candidate = unvisited;
+            for (auto predecessor : predecessors[node])
+            {
+                if (dominator[predecessor] == unvisited) continue;
+                candidate = candidate == unvisited ? predecessor : intersect(predecessor, candidate);
+            }
+
+            if (dominator[node] != candidate)
+            {
+                dominator[node] = candidate;
+                changed = true;
+            }
+        }
+    }
+
+    // dominated nodes come after their dominator in reverse postorder.
+    std::vector<std::uint64_t> retained(count + 1, 0);
+    for (std::size_t node = 0; node < count; node++)
+    {
+        retained[node] = snapshot.nodes[node].size;
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        if (*it != root) retained[dominator[*it]] += retained[*it];
+    }
+
+    std::uint64_t kindCount[12] = {}, kindSize[12] = {};
+    for (auto & node : snapshot.nodes)
+    {
+        kindCount[static_cast<int>(node.kind)]++;
+        kindSize[static_cast<int>(node.kind)] += node.size;
+    }
+
+    std::cout << count << " objects, " << retained[root] << " bytes reachable\n\n"
+              << std::setw(12) << "count" << std::setw(14) << "bytes" << "  kind\n";
+    for (int kind = 0; kind < 12; kind++)
+    {
+        if (kindCount[kind] == 0) continue;
+        std::cout << std::setw(12) << kindCount[kind] << std::setw(14) << kindSize[kind] << "  " << kindName(static_cast<HeapSnapshot::Kind>(kind)) << '\n';
+    }
+
+    std::vector<std::size_t> largest;
+    for (std::size_t node = 0; node < count; node++)
+    {
+        if (dominator[node] != unvisited) largest.push_back(node);
+    }
+    top = std::min(top, largest.size());
+    std::partial_sort(largest.begin(), largest.begin() + top, largest.end(), [&](auto a, auto b) { return retained[a] > retained[b]; });
+
+    std::cout << '\n' << std::setw(12) << "retained" << std::setw(14) << "self" << "  object, dominator path\n";
+    for (std::size_t i = 0; i < top; i++)
+    {
+        auto node = largest[i];
+        std::cout << std::setw(12) << retained[node] << std::setw(14) << snapshot.nodes[node].size << "  " << snapshot.nodes[node].label << '\n';
+
+        // the closest dominators, long chains are cut.
+        constexpr int hops = 4;
+        std::string path;
+        int depth = 0;
+        for (auto parent = dominator[node]; parent != root; parent = dominator[parent])
+        {
+            if (++depth > hops)
+            {
+                path = "... -> " + path;
+                break;
+            }
+            path = snapshot.nodes[parent].label + (path.empty() ? "" : " -> ") + path;
+        }
+        std::cout << std::setw(28) << "" << "  via " << (path.empty() ? "(root)" : path) << '\n';
+    }
+
+    return 0;
+}